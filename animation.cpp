@@ -0,0 +1,73 @@
+#include "animation.h"
+#include "simd.h"
+
+#include <cstring>
+
+uint16_t animationAddType(AnimationTable* table, const Sprite* const* frames, size_t frameNum, uint16_t frameDuration, uint16_t phase){
+    AnimationType& type = table->types[table->typeNum];
+    type.frameNum = frameNum;
+    type.frameDuration = frameDuration ? frameDuration : 1;
+    type.phase = phase;
+    for (size_t i = 0; i < frameNum; i++){
+        type.frames[i] = frames[i];
+    }
+    return (uint16_t)table->typeNum++;
+}
+
+void animationInit(AnimationSystem* system, Arena* arena, size_t capacity){
+    system->capacity = capacity;
+    system->count = 0;
+    system->type = arenaAlloc<uint16_t>(arena, capacity);
+    system->counter = arenaAlloc<uint16_t>(arena, capacity);
+    system->frame = arenaAlloc<uint16_t>(arena, capacity);
+    system->duration = arenaAlloc<uint16_t>(arena, capacity);
+    system->frameNum = arenaAlloc<uint16_t>(arena, capacity);
+}
+
+void animationSet(AnimationSystem* system, const AnimationTable& table, size_t instance, uint16_t type, uint16_t phase){
+    const AnimationType& animation = table.types[type];
+    size_t time = ((size_t)animation.phase + phase) % (animation.frameNum * animation.frameDuration);
+
+    system->type[instance] = type;
+    system->counter[instance] = (uint16_t)(time % animation.frameDuration);
+    system->frame[instance] = (uint16_t)(time / animation.frameDuration);
+    system->duration[instance] = animation.frameDuration;
+    system->frameNum[instance] = (uint16_t)animation.frameNum;
+}
+
+size_t animationAdd(AnimationSystem* system, const AnimationTable& table, uint16_t type, uint16_t phase){
+    size_t instance = system->count++;
+    animationSet(system, table, instance, type, phase);
+    return instance;
+}
+
+void animationTick(AnimationSystem* system){
+    size_t i = 0;
+
+#if USE_SSE2
+    __m128i one = _mm_set1_epi16(1);
+    for (; i + 8 <= system->count; i += 8){
+        __m128i counter = _mm_loadu_si128((const __m128i*)(system->counter + i));
+        __m128i frame = _mm_loadu_si128((const __m128i*)(system->frame + i));
+        __m128i duration = _mm_loadu_si128((const __m128i*)(system->duration + i));
+        __m128i frameNum = _mm_loadu_si128((const __m128i*)(system->frameNum + i));
+
+        //lanes that finish their frame reset the counter and step the frame, wrapping at frameNum
+        counter = _mm_add_epi16(counter, one);
+        __m128i step = _mm_cmpeq_epi16(counter, duration);
+        counter = _mm_andnot_si128(step, counter);
+        frame = _mm_sub_epi16(frame, step);
+        frame = _mm_andnot_si128(_mm_cmpeq_epi16(frame, frameNum), frame);
+
+        _mm_storeu_si128((__m128i*)(system->counter + i), counter);
+        _mm_storeu_si128((__m128i*)(system->frame + i), frame);
+    }
+#endif
+
+    for (; i < system->count; i++){
+        if (++system->counter[i] == system->duration[i]){
+            system->counter[i] = 0;
+            if (++system->frame[i] == system->frameNum[i]) system->frame[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "render.h"
+#include "arena.h"
+
+#define ANIMATION_MAX_TYPES 16
+#define ANIMATION_MAX_FRAMES 8
+
+//read-only frame table shared by every instance of a type
+struct AnimationType{
+    size_t frameNum;
+    uint16_t frameDuration;
+    uint16_t phase;
+    const Sprite* frames[ANIMATION_MAX_FRAMES];
+};
+
+struct AnimationTable{
+    size_t typeNum;
+    AnimationType types[ANIMATION_MAX_TYPES];
+};
+
+//per-instance playback state in SoA form. duration and frameNum are copied out
+//of the type table so that animationTick never has to look anything up.
+struct AnimationSystem{
+    size_t capacity;
+    size_t count;
+    RelPtr<uint16_t> type;
+    RelPtr<uint16_t> counter;
+    RelPtr<uint16_t> frame;
+    RelPtr<uint16_t> duration;
+    RelPtr<uint16_t> frameNum;
+};
+
+uint16_t animationAddType(AnimationTable* table, const Sprite* const* frames, size_t frameNum, uint16_t frameDuration, uint16_t phase);
+
+void animationInit(AnimationSystem* system, Arena* arena, size_t capacity);
+
+//instances start (type phase + phase) ticks into the loop
+size_t animationAdd(AnimationSystem* system, const AnimationTable& table, uint16_t type, uint16_t phase);
+void animationSet(AnimationSystem* system, const AnimationTable& table, size_t instance, uint16_t type, uint16_t phase);
+
+//advances every instance by one tick
+void animationTick(AnimationSystem* system);
+
+inline const Sprite& animationSprite(const AnimationTable& table, const AnimationSystem& system, size_t instance){
+    return *table.types[system.type[instance]].frames[system.frame[instance]];
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//stores the distance from itself to its target, so a block holding both the pointer
+//and the target can be moved or copied with a plain memcpy and stay valid. copying a
+//RelPtr on its own out of its block breaks it.
+template <typename T>
+struct RelPtr{
+    int64_t offset;
+
+    T* get() const{
+        return offset ? (T*)((const uint8_t*)this + offset) : nullptr;
+    }
+    operator T*() const{
+        return get();
+    }
+    T* operator->() const{
+        return get();
+    }
+    RelPtr& operator=(T* target){
+        offset = target ? (int64_t)((uint8_t*)target - (uint8_t*)this) : 0;
+        return *this;
+    }
+};
+
+//bump allocator over one caller-owned block. an arena with a null base only measures:
+//allocations return nullptr and advance used, so the same layout code can size a
+//block before it exists.
+struct Arena{
+    uint8_t* base;
+    size_t size;
+    size_t used;
+};
+
+inline void arenaInit(Arena* arena, void* base, size_t size){
+    arena->base = (uint8_t*)base;
+    arena->size = size;
+    arena->used = 0;
+}
+
+inline bool arenaMeasuring(const Arena& arena){
+    return !arena.base;
+}
+
+template <typename T>
+T* arenaAlloc(Arena* arena, size_t count, size_t align = 16){
+    size_t start = (arena->used + align - 1) & ~(align - 1);
+    arena->used = start + count * sizeof(T);
+    if (!arena->base) return nullptr;
+    return (T*)(arena->base + start);
+}
@@ -0,0 +1,195 @@
+#include "assets.h"
+#include "sprites.h"
+
+#include <cstring>
+
+//baked into read-only data at compile time, see sprites.h
+SPRITE_BAKE(alienA0Rows, 8, 8,
+    "...@@..."
+    "..@@@@.."
+    ".@@@@@@."
+    "@@.@@.@@"
+    "@@@@@@@@"
+    ".@.@@.@."
+    "@......@"
+    ".@....@.");
+
+SPRITE_BAKE(alienA1Rows, 8, 8,
+    "...@@..."
+    "..@@@@.."
+    ".@@@@@@."
+    "@@.@@.@@"
+    "@@@@@@@@"
+    "..@..@.."
+    ".@.@@.@."
+    "@.@..@.@");
+
+SPRITE_BAKE(alienB0Rows, 11, 8,
+    "..@.....@.."
+    "...@...@..."
+    "..@@@@@@@.."
+    ".@@.@@@.@@."
+    "@@@@@@@@@@@"
+    "@.@@@@@@@.@"
+    "@.@.....@.@"
+    "...@@.@@...");
+
+SPRITE_BAKE(alienB1Rows, 11, 8,
+    "..@.....@.."
+    "@..@...@..@"
+    "@.@@@@@@@.@"
+    "@@@.@@@.@@@"
+    "@@@@@@@@@@@"
+    ".@@@@@@@@@."
+    "..@.....@.."
+    ".@.......@.");
+
+SPRITE_BAKE(alienC0Rows, 12, 8,
+    "....@@@@...."
+    ".@@@@@@@@@@."
+    "@@@@@@@@@@@@"
+    "@@@..@@..@@@"
+    "@@@@@@@@@@@@"
+    "...@@..@@..."
+    "..@@.@@.@@.."
+    "@@........@@");
+
+SPRITE_BAKE(alienC1Rows, 12, 8,
+    "....@@@@...."
+    ".@@@@@@@@@@."
+    "@@@@@@@@@@@@"
+    "@@@..@@..@@@"
+    "@@@@@@@@@@@@"
+    "..@@@..@@@.."
+    ".@@..@@..@@."
+    "..@@....@@..");
+
+SPRITE_BAKE(alienDeathRows, 13, 7,
+    ".@..@...@..@."
+    "..@..@.@..@.."
+    "...@.....@..."
+    "@@.........@@"
+    "...@.....@..."
+    "..@..@.@..@.."
+    ".@..@...@..@.");
+
+SPRITE_BAKE(playerRows, 11, 7,
+    ".....@....."
+    "....@@@...."
+    "....@@@...."
+    ".@@@@@@@@@."
+    "@@@@@@@@@@@"
+    "@@@@@@@@@@@"
+    "@@@@@@@@@@@");
+
+SPRITE_BAKE(bulletRows, 1, 3,
+    "@"
+    "@"
+    "@");
+
+//glyphs for characters 32 to 96, one per line, 5x7 pixels each
+SPRITE_BAKE_SHEET(textRows, 5, 7, 65,
+    "....." "....." "....." "....." "....." "....." "....." //space
+    "..@.." "..@.." "..@.." "..@.." "..@.." "....." "..@.." //!
+    ".@.@." ".@.@." "....." "....." "....." "....." "....." //"
+    ".@.@." ".@.@." "@@@@@" ".@.@." "@@@@@" ".@.@." ".@.@." //#
+    "..@.." ".@@@." "@.@.." ".@@@." "..@.@" ".@@@." "..@.." //$
+    "@@.@." "@@.@." "..@.." "..@.." "..@.." ".@.@@" ".@.@@" //%
+    ".@@.." "@..@." "@..@." ".@@.." "@..@." "@...@" ".@@@@" //&
+    "...@." "..@.." "....." "....." "....." "....." "....." //'
+    "....@" "...@." "..@.." "..@.." "..@.." "...@." "....@" //(
+    "@...." ".@..." "..@.." "..@.." "..@.." ".@..." "@...." //)
+    "..@.." "@.@.@" ".@@@." "..@.." ".@@@." "@.@.@" "..@.." //*
+    "....." "..@.." "..@.." "@@@@@" "..@.." "..@.." "....." //+
+    "....." "....." "....." "....." "....." "..@.." "..@.." //,
+    "....." "....." "....." "@@@@@" "....." "....." "....." //-
+    "....." "....." "....." "....." "....." "....." "..@.." //.
+    "...@." "...@." "..@.." "..@.." "..@.." ".@..." ".@..." ///
+    ".@@@." "@...@" "@..@@" "@.@.@" "@@..@" "@...@" ".@@@." //0
+    "..@.." ".@@.." "..@.." "..@.." "..@.." "..@.." ".@@@." //1
+    ".@@@." "@...@" "....@" "..@@." ".@..." "@...." "@@@@@" //2
+    "@@@@@" "....@" "...@." "..@@." "....@" "@...@" ".@@@." //3
+    "...@." "..@@." ".@.@." "@..@." "@@@@@" "...@." "...@." //4
+    "@@@@@" "@...." "@@@@." "....@" "....@" "@...@" ".@@@." //5
+    ".@@@." "@...@" "@...." "@@@@." "@...@" "@...@" ".@@@." //6
+    "@@@@@" "....@" "...@." "..@.." ".@..." ".@..." ".@..." //7
+    ".@@@." "@...@" "@...@" ".@@@." "@...@" "@...@" ".@@@." //8
+    ".@@@." "@...@" "@...@" ".@@@@" "....@" "@...@" ".@@@." //9
+    "....." "..@.." "....." "....." "....." "..@.." "....." //:
+    "....." "..@.." "....." "....." "....." "..@.." "..@.." //;
+    "....@" "...@." "..@.." ".@..." "..@.." "...@." "....@" //<
+    "....." "....." "@@@@@" "....." "@@@@@" "....." "....." //=
+    "@...." ".@..." "..@.." "...@." "..@.." ".@..." "@...." //>
+    ".@@@." "@...@" "...@." "..@.." "..@.." "....." "..@.." //?
+    ".@@@." "@...@" "@.@.@" "@@.@@" "@.@.." "@...@" ".@@@." //@
+    "..@.." ".@.@." "@...@" "@...@" "@@@@@" "@...@" "@...@" //A
+    "@@@@." "@...@" "@...@" "@@@@." "@...@" "@...@" "@@@@." //B
+    ".@@@." "@...@" "@...." "@...." "@...." "@...@" ".@@@." //C
+    "@@@@." "@...@" "@...@" "@...@" "@...@" "@...@" "@@@@." //D
+    "@@@@@" "@...." "@...." "@@@@." "@...." "@...." "@@@@@" //E
+    "@@@@@" "@...." "@...." "@@@@." "@...." "@...." "@...." //F
+    ".@@@." "@...@" "@...." "@.@@@" "@...@" "@...@" ".@@@." //G
+    "@...@" "@...@" "@...@" "@@@@@" "@...@" "@...@" "@...@" //H
+    ".@@@." "..@.." "..@.." "..@.." "..@.." "..@.." ".@@@." //I
+    "....@" "....@" "....@" "....@" "....@" "@...@" ".@@@." //J
+    "@...@" "@..@." "@.@.." "@@..." "@.@.." "@..@." "@...@" //K
+    "@...." "@...." "@...." "@...." "@...." "@...." "@@@@@" //L
+    "@...@" "@@.@@" "@.@.@" "@.@.@" "@...@" "@...@" "@...@" //M
+    "@...@" "@...@" "@@..@" "@.@.@" "@..@@" "@...@" "@...@" //N
+    ".@@@." "@...@" "@...@" "@...@" "@...@" "@...@" ".@@@." //O
+    "@@@@." "@...@" "@...@" "@@@@." "@...." "@...." "@...." //P
+    ".@@@." "@...@" "@...@" "@...@" "@.@.@" "@..@@" ".@@@@" //Q
+    "@@@@." "@...@" "@...@" "@@@@." "@.@.." "@..@." "@...@" //R
+    ".@@@." "@...@" "@...." ".@@@." "@...@" "....@" ".@@@." //S
+    "@@@@@" "..@.." "..@.." "..@.." "..@.." "..@.." "..@.." //T
+    "@...@" "@...@" "@...@" "@...@" "@...@" "@...@" ".@@@." //U
+    "@...@" "@...@" "@...@" "@...@" "@...@" ".@.@." "..@.." //V
+    "@...@" "@...@" "@...@" "@.@.@" "@.@.@" "@@.@@" "@...@" //W
+    "@...@" "@...@" ".@.@." "..@.." ".@.@." "@...@" "@...@" //X
+    "@...@" "@...@" ".@.@." "..@.." "..@.." "..@.." "..@.." //Y
+    "@@@@@" "....@" "...@." "..@.." ".@..." "@...." "@@@@@" //Z
+    "...@@" "..@.." "..@.." "..@.." "..@.." "..@.." "...@@" //[
+    ".@..." ".@..." "..@.." "..@.." "..@.." "...@." "...@." //backslash
+    "@@..." "..@.." "..@.." "..@.." "..@.." "..@.." "@@..." //]
+    "..@.." ".@.@." "@...@" "....." "....." "....." "....." //^
+    "....." "....." "....." "....." "....." "....." "@@@@@" //_
+    "..@.." "...@." "....." "....." "....." "....." "....."); //`
+
+static void spriteSet(Sprite* sprite, size_t width, size_t height, const uint32_t* rows){
+    sprite->width = width;
+    sprite->height = height;
+    sprite->rows = rows;
+}
+
+void assetsInit(Assets* assets){
+    memset(&assets->atlas, 0, sizeof(MappedFile));
+
+    //alien sprites, two frames per alien type
+    spriteSet(&assets->alienSprites[0], 8, 8, alienA0Rows.rows);
+    spriteSet(&assets->alienSprites[1], 8, 8, alienA1Rows.rows);
+    spriteSet(&assets->alienSprites[2], 11, 8, alienB0Rows.rows);
+    spriteSet(&assets->alienSprites[3], 11, 8, alienB1Rows.rows);
+    spriteSet(&assets->alienSprites[4], 12, 8, alienC0Rows.rows);
+    spriteSet(&assets->alienSprites[5], 12, 8, alienC1Rows.rows);
+    spriteSet(&assets->alienDeathSprite, 13, 7, alienDeathRows.rows);
+    spriteSet(&assets->playerSprite, 11, 7, playerRows.rows);
+    spriteSet(&assets->bulletSprite, 1, 3, bulletRows.rows);
+
+    //text and number spritesheets, the digits start at '0'
+    spriteSet(&assets->textSheet, 5, 7, textRows.rows);
+    assets->numberSheet = assets->textSheet;
+    assets->numberSheet.rows += 16 * 7;
+
+    //create alien animations, one type per alien type
+    assets->alienAnimations.typeNum = 0;
+
+    for (size_t i = 0; i < 3; i++){
+        const Sprite* frames[2] = { &assets->alienSprites[2 * i], &assets->alienSprites[2 * i + 1] };
+        animationAddType(&assets->alienAnimations, frames, 2, 10, 0);
+    }
+}
+
+void assetsFree(Assets* assets){
+    //baked sprites are static data, only an atlas has anything to release
+    if (assets->atlas.data) unmapFile(&assets->atlas);
+}
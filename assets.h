@@ -0,0 +1,20 @@
+#pragma once
+
+#include "render.h"
+#include "animation.h"
+#include "mapfile.h"
+
+struct Assets{
+    Sprite alienSprites[6];
+    Sprite alienDeathSprite;
+    Sprite playerSprite;
+    Sprite bulletSprite;
+    Sprite textSheet;
+    Sprite numberSheet;
+    AnimationTable alienAnimations;
+    MappedFile atlas; //set when the sprites come from an atlas file rather than the baked ones
+};
+
+//the sprites baked into the executable, see atlas.h for loading them from a file
+void assetsInit(Assets* assets);
+void assetsFree(Assets* assets);
@@ -0,0 +1,296 @@
+#include "atlas.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+using namespace std;
+
+static_assert(sizeof(AtlasHeader) == 40, "atlas header layout is part of the file format");
+static_assert(sizeof(AtlasSprite) == 16, "atlas sprite layout is part of the file format");
+static_assert(sizeof(AtlasAnimation) == 6 + 2 * ANIMATION_MAX_FRAMES, "atlas animation layout is part of the file format");
+
+//the game animates aliens with the first three animation types, and the number sheet
+//starts at '0' of the text sheet
+#define ATLAS_MIN_ANIMATIONS 3
+#define ATLAS_MIN_GLYPHS 65
+
+static Sprite* atlasSlot(Assets* assets, size_t slot){
+    if (slot < 6) return &assets->alienSprites[slot];
+    if (slot == ATLAS_ALIEN_DEATH) return &assets->alienDeathSprite;
+    if (slot == ATLAS_PLAYER) return &assets->playerSprite;
+    if (slot == ATLAS_BULLET) return &assets->bulletSprite;
+    return &assets->textSheet;
+}
+
+static const Sprite* atlasSlot(const Assets& assets, size_t slot){
+    return atlasSlot(const_cast<Assets*>(&assets), slot);
+}
+
+bool atlasWrite(const Assets& assets, const char* path){
+    const AnimationTable& table = assets.alienAnimations;
+
+    AtlasHeader header;
+    memset(&header, 0, sizeof(AtlasHeader));
+    header.magic = ATLAS_MAGIC;
+    header.version = ATLAS_VERSION;
+    header.spriteNum = ATLAS_SLOT_COUNT;
+    header.spriteOffset = sizeof(AtlasHeader);
+    header.animationNum = (uint32_t)table.typeNum;
+    header.animationOffset = header.spriteOffset + header.spriteNum * sizeof(AtlasSprite);
+
+    AtlasSprite sprites[ATLAS_SLOT_COUNT];
+    vector<uint32_t> rows;
+    for (size_t i = 0; i < ATLAS_SLOT_COUNT; i++){
+        const Sprite& sprite = *atlasSlot(assets, i);
+        sprites[i].width = (uint32_t)sprite.width;
+        sprites[i].height = (uint32_t)sprite.height;
+        sprites[i].firstRow = (uint32_t)rows.size();
+        sprites[i].glyphNum = i == ATLAS_TEXT ? ATLAS_MIN_GLYPHS : 1;
+        rows.insert(rows.end(), sprite.rows, sprite.rows + sprite.height * sprites[i].glyphNum);
+    }
+
+    vector<AtlasAnimation> animations(table.typeNum);
+    for (size_t i = 0; i < table.typeNum; i++){
+        const AnimationType& type = table.types[i];
+        AtlasAnimation& animation = animations[i];
+        memset(&animation, 0, sizeof(AtlasAnimation));
+        animation.frameNum = (uint16_t)type.frameNum;
+        animation.frameDuration = type.frameDuration;
+        animation.phase = type.phase;
+        for (size_t j = 0; j < type.frameNum; j++){
+            for (uint16_t slot = 0; slot < ATLAS_SLOT_COUNT; slot++){
+                if (atlasSlot(assets, slot) == type.frames[j]) animation.frames[j] = slot;
+            }
+        }
+    }
+
+    //rows start 4 byte aligned, animations are 2 byte aligned and their count may be odd
+    header.rowOffset = (uint32_t)(header.animationOffset + animations.size() * sizeof(AtlasAnimation) + 3) & ~3u;
+    header.rowNum = (uint32_t)rows.size();
+    header.size = header.rowOffset + rows.size() * sizeof(uint32_t);
+
+    vector<uint8_t> image((size_t)header.size, 0);
+    memcpy(image.data(), &header, sizeof(AtlasHeader));
+    memcpy(image.data() + header.spriteOffset, sprites, sizeof(sprites));
+    if (!animations.empty()) memcpy(image.data() + header.animationOffset, animations.data(), animations.size() * sizeof(AtlasAnimation));
+    memcpy(image.data() + header.rowOffset, rows.data(), rows.size() * sizeof(uint32_t));
+
+    //a running game may have the old file mapped, replacing it keeps that mapping intact
+    string temp = string(path) + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (!file){
+        cout << "Failed to create " << temp << endl;
+        return false;
+    }
+    bool ok = fwrite(image.data(), 1, image.size(), file) == image.size();
+    if (fclose(file) != 0) ok = false;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(temp.c_str(), path, MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(temp.c_str(), path) == 0;
+#endif
+    if (!ok){
+        cout << "Failed to write " << path << endl;
+        remove(temp.c_str());
+    }
+    return ok;
+}
+
+static bool atlasValid(const MappedFile& file){
+    if (file.size < sizeof(AtlasHeader)) return false;
+    const AtlasHeader& header = *(const AtlasHeader*)file.data;
+    if (header.magic != ATLAS_MAGIC || header.version != ATLAS_VERSION || header.size != file.size) return false;
+
+    //every table must lie inside the file, aligned for its type
+    if (header.spriteNum != ATLAS_SLOT_COUNT || header.animationNum < ATLAS_MIN_ANIMATIONS || header.animationNum > ANIMATION_MAX_TYPES) return false;
+    if (header.spriteOffset % 4 || header.animationOffset % 2 || header.rowOffset % 4) return false;
+    if ((uint64_t)header.spriteOffset + header.spriteNum * sizeof(AtlasSprite) > file.size) return false;
+    if ((uint64_t)header.animationOffset + header.animationNum * sizeof(AtlasAnimation) > file.size) return false;
+    if ((uint64_t)header.rowOffset + (uint64_t)header.rowNum * sizeof(uint32_t) > file.size) return false;
+
+    const AtlasSprite* sprites = (const AtlasSprite*)(file.data + header.spriteOffset);
+    for (size_t i = 0; i < header.spriteNum; i++){
+        const AtlasSprite& sprite = sprites[i];
+        uint32_t glyphNum = i == ATLAS_TEXT ? ATLAS_MIN_GLYPHS : 1;
+        if (!sprite.width || sprite.width > 32 || !sprite.height || sprite.glyphNum < glyphNum) return false;
+        if ((uint64_t)sprite.firstRow + (uint64_t)sprite.height * sprite.glyphNum > header.rowNum) return false;
+    }
+
+    const AtlasAnimation* animations = (const AtlasAnimation*)(file.data + header.animationOffset);
+    for (size_t i = 0; i < header.animationNum; i++){
+        const AtlasAnimation& animation = animations[i];
+        if (!animation.frameNum || animation.frameNum > ANIMATION_MAX_FRAMES) return false;
+        for (size_t j = 0; j < animation.frameNum; j++){
+            if (animation.frames[j] >= header.spriteNum) return false;
+        }
+    }
+    return true;
+}
+
+//points every sprite and animation of assets into a checked atlas, nothing is copied
+static void atlasBind(Assets* assets, const MappedFile& file){
+    const AtlasHeader& header = *(const AtlasHeader*)file.data;
+    const AtlasSprite* sprites = (const AtlasSprite*)(file.data + header.spriteOffset);
+    const AtlasAnimation* animations = (const AtlasAnimation*)(file.data + header.animationOffset);
+    const uint32_t* rows = (const uint32_t*)(file.data + header.rowOffset);
+
+    for (size_t i = 0; i < ATLAS_SLOT_COUNT; i++){
+        Sprite* sprite = atlasSlot(assets, i);
+        sprite->width = sprites[i].width;
+        sprite->height = sprites[i].height;
+        sprite->rows = rows + sprites[i].firstRow;
+    }
+    assets->numberSheet = assets->textSheet;
+    assets->numberSheet.rows += 16 * assets->textSheet.height;
+
+    assets->alienAnimations.typeNum = 0;
+    for (size_t i = 0; i < header.animationNum; i++){
+        const Sprite* frames[ANIMATION_MAX_FRAMES];
+        for (size_t j = 0; j < animations[i].frameNum; j++){
+            frames[j] = atlasSlot(assets, animations[i].frames[j]);
+        }
+        animationAddType(&assets->alienAnimations, frames, animations[i].frameNum, animations[i].frameDuration, animations[i].phase);
+    }
+}
+
+//binds the new atlas before the old mapping goes, so assets never point at unmapped rows
+static void atlasSwap(Assets* assets, const MappedFile& file){
+    MappedFile previous = assets->atlas;
+    atlasBind(assets, file);
+    assets->atlas = file;
+    if (previous.data) unmapFile(&previous);
+}
+
+static bool atlasMap(MappedFile* file, const char* path){
+    if (!mapFile(file, path)) return false;
+    if (!file->data || !atlasValid(*file)){
+        cout << path << " is not a version " << ATLAS_VERSION << " sprite atlas" << endl;
+        unmapFile(file);
+        return false;
+    }
+    return true;
+}
+
+bool atlasLoad(Assets* assets, const char* path){
+    MappedFile file;
+    if (!atlasMap(&file, path)) return false;
+
+    atlasSwap(assets, file);
+    return true;
+}
+
+bool atlasReload(Assets* assets, const char* path){
+    MappedFile file;
+    if (!atlasMap(&file, path)) return false;
+
+    Assets fresh = *assets;
+    atlasBind(&fresh, file);
+
+    bool same = fresh.alienAnimations.typeNum == assets->alienAnimations.typeNum;
+    for (size_t i = 0; i < ATLAS_SLOT_COUNT && same; i++){
+        const Sprite& a = *atlasSlot(&fresh, i);
+        const Sprite& b = *atlasSlot(assets, i);
+        same = a.width == b.width && a.height == b.height;
+    }
+    for (size_t i = 0; i < fresh.alienAnimations.typeNum && same; i++){
+        const AnimationType& a = fresh.alienAnimations.types[i];
+        const AnimationType& b = assets->alienAnimations.types[i];
+        same = a.frameNum == b.frameNum && a.frameDuration == b.frameDuration && a.phase == b.phase;
+    }
+    if (!same){
+        cout << path << " changes sprite sizes or animation timing, keeping the current atlas" << endl;
+        unmapFile(&file);
+        return false;
+    }
+
+    atlasSwap(assets, file);
+    return true;
+}
+
+bool atlasWatch(AtlasWatch* watch, const char* path){
+    memset(watch, 0, sizeof(AtlasWatch));
+    const char* slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char* backslash = strrchr(path, '\\');
+    if (!slash || (backslash && backslash > slash)) slash = backslash;
+#endif
+    watch->file = slash ? slash + 1 : path;
+    size_t length = slash ? (size_t)(slash - path) : 0;
+    if (length >= sizeof(watch->directory)){
+        cout << "Path too long to watch: " << path << endl;
+        return false;
+    }
+    if (slash) memcpy(watch->directory, path, length ? length : 1);
+    else strcpy(watch->directory, ".");
+
+#if defined(_WIN32)
+    //directory handles fire for any file in it, a spurious reload is checked and harmless
+    watch->handle = FindFirstChangeNotificationA(watch->directory, FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (watch->handle == INVALID_HANDLE_VALUE){
+        watch->handle = nullptr;
+        cout << "Failed to watch " << watch->directory << endl;
+        return false;
+    }
+#elif defined(__linux__)
+    //the directory is watched rather than the file, atlasWrite replaces the file by renaming
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0 || inotify_add_watch(watch->fd, watch->directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+        cout << "Failed to watch " << watch->directory << endl;
+        atlasUnwatch(watch);
+        return false;
+    }
+#else
+    watch->fd = -1;
+    cout << "Atlas hot reload is not supported on this platform" << endl;
+    return false;
+#endif
+    return true;
+}
+
+bool atlasChanged(AtlasWatch* watch){
+    bool changed = false;
+#if defined(_WIN32)
+    if (!watch->handle) return false;
+    while (WaitForSingleObject((HANDLE)watch->handle, 0) == WAIT_OBJECT_0){
+        changed = true;
+        FindNextChangeNotification((HANDLE)watch->handle);
+    }
+#elif defined(__linux__)
+    if (watch->fd < 0) return false;
+    alignas(inotify_event) char events[4096];
+    for (;;){
+        ssize_t length = read(watch->fd, events, sizeof(events));
+        if (length <= 0) break;
+        for (ssize_t i = 0; i < length;){
+            const inotify_event* event = (const inotify_event*)(events + i);
+            if (event->len && !strcmp(event->name, watch->file)) changed = true;
+            i += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
+
+void atlasUnwatch(AtlasWatch* watch){
+#ifdef _WIN32
+    if (watch->handle) FindCloseChangeNotification((HANDLE)watch->handle);
+    watch->handle = nullptr;
+#else
+    if (watch->fd >= 0) close(watch->fd);
+    watch->fd = -1;
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "assets.h"
+
+#define ATLAS_MAGIC 0x54414953u //"SIAT"
+#define ATLAS_VERSION 1
+
+//sprite slots of an atlas, in Assets order
+enum AtlasSlot{
+    ATLAS_ALIEN_A0 = 0,
+    ATLAS_ALIEN_A1,
+    ATLAS_ALIEN_B0,
+    ATLAS_ALIEN_B1,
+    ATLAS_ALIEN_C0,
+    ATLAS_ALIEN_C1,
+    ATLAS_ALIEN_DEATH,
+    ATLAS_PLAYER,
+    ATLAS_BULLET,
+    ATLAS_TEXT,
+    ATLAS_SLOT_COUNT
+};
+
+//binary sprite atlas, used in place straight from a read-only mapping. the header is
+//followed by spriteNum AtlasSprite, animationNum AtlasAnimation and rowNum uint32_t row
+//masks, each at its offset from the start of the file. rows are in Sprite order, bottom
+//row first, glyphs of a sheet back to back.
+struct AtlasHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint32_t spriteNum, spriteOffset;
+    uint32_t animationNum, animationOffset;
+    uint32_t rowNum, rowOffset;
+};
+
+struct AtlasSprite{
+    uint32_t width, height;
+    uint32_t firstRow;
+    uint32_t glyphNum;
+};
+
+//frames are sprite slots
+struct AtlasAnimation{
+    uint16_t frameNum;
+    uint16_t frameDuration;
+    uint16_t phase;
+    uint16_t frames[ANIMATION_MAX_FRAMES];
+};
+
+//writes assets as an atlas. the file is written beside path and renamed over it, so a
+//running game never sees it half written
+bool atlasWrite(const Assets& assets, const char* path);
+
+//maps and checks the atlas at path and points assets into it. on failure assets are left
+//as they were
+bool atlasLoad(Assets* assets, const char* path);
+
+//swaps a changed atlas in between frames. sprite sizes and animation timing feed the
+//simulation, so an atlas that changes them is refused and the current one kept
+bool atlasReload(Assets* assets, const char* path);
+
+//change notifications for one atlas file, inotify on linux and a directory change
+//handle on windows. polling never blocks
+struct AtlasWatch{
+    char directory[260];
+    const char* file;
+#ifdef _WIN32
+    void* handle;
+#else
+    int fd;
+#endif
+};
+
+bool atlasWatch(AtlasWatch* watch, const char* path);
+bool atlasChanged(AtlasWatch* watch);
+void atlasUnwatch(AtlasWatch* watch);
@@ -0,0 +1,312 @@
+#include "batch.h"
+#include "game.h"
+#include "simd.h"
+#include "rng.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const size_t cacheLine = 64;
+
+static size_t alignUp(size_t value, size_t alignment){
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void batchInit(BatchSim* sim, size_t num, const GameConfig& config, const Assets& assets){
+    memset(sim, 0, sizeof(BatchSim));
+    sim->num = alignUp(num ? num : 1, BATCH_BLOCK);
+    sim->alienNum = config.rows * config.cols;
+    sim->width = (int32_t)config.width;
+    sim->height = (int32_t)config.height;
+    sim->playerY = 32;
+    sim->playerWidth = (int32_t)assets.playerSprite.width;
+    sim->playerHeight = (int32_t)assets.playerSprite.height;
+    sim->bulletHeight = (int32_t)assets.bulletSprite.height;
+
+    //one allocation, every array starts on a cache line so shards never share one
+    size_t alienBytes = alignUp(sim->alienNum * sizeof(int32_t), cacheLine);
+    size_t laneBytes = sim->num * sizeof(int32_t);
+    size_t bytes = 5 * alienBytes + 5 * laneBytes + 3 * BATCH_BULLETS * laneBytes + sim->alienNum * laneBytes + alignUp(sim->num, cacheLine) + cacheLine;
+    sim->memory = new uint8_t[bytes];
+
+    uint8_t* p = (uint8_t*)alignUp((size_t)sim->memory, cacheLine);
+    int32_t** alienArrays[] = { &sim->alienX, &sim->alienY, &sim->alienRight, &sim->alienTop, &sim->alienPoints };
+    for (int32_t** array : alienArrays){
+        *array = (int32_t*)p;
+        p += alienBytes;
+    }
+    int32_t** laneArrays[] = { &sim->playerX, &sim->score, &sim->reward, &sim->done, &sim->liveNum };
+    for (int32_t** array : laneArrays){
+        *array = (int32_t*)p;
+        p += laneBytes;
+    }
+    sim->bulletX = (int32_t*)p;
+    p += BATCH_BULLETS * laneBytes;
+    sim->bulletY = (int32_t*)p;
+    p += BATCH_BULLETS * laneBytes;
+    sim->bulletActive = (int32_t*)p;
+    p += BATCH_BULLETS * laneBytes;
+    sim->alive = (int32_t*)p;
+    p += sim->alienNum * laneBytes;
+    sim->action = p;
+
+    //same layout as gameCreate
+    for (size_t i = 0; i < config.rows; i++){
+        for (size_t j = 0; j < config.cols; j++){
+            size_t alien = i * config.cols + j;
+            size_t type = alienTypeOf(i, config.rows);
+            const Sprite& sprite = assets.alienSprites[2 * (type - 1)];
+
+            sim->alienX[alien] = (int32_t)(16 * j + 20 + (assets.alienDeathSprite.width - sprite.width) / 2);
+            sim->alienY[alien] = (int32_t)(17 * i + 128);
+            sim->alienRight[alien] = sim->alienX[alien] + (int32_t)sprite.width;
+            sim->alienTop[alien] = sim->alienY[alien] + (int32_t)sprite.height;
+            sim->alienPoints[alien] = (int32_t)(10 * (4 - type));
+        }
+    }
+
+    batchReset(sim, 0, sim->num);
+}
+
+void batchFree(BatchSim* sim){
+    delete[] sim->memory;
+    memset(sim, 0, sizeof(BatchSim));
+}
+
+static void batchResetWave(BatchSim* sim, size_t instance){
+    for (size_t j = 0; j < sim->alienNum; j++){
+        sim->alive[j * sim->num + instance] = -1;
+    }
+    for (size_t k = 0; k < BATCH_BULLETS; k++){
+        sim->bulletActive[k * sim->num + instance] = 0;
+    }
+    sim->liveNum[instance] = (int32_t)sim->alienNum;
+}
+
+void batchReset(BatchSim* sim, size_t begin, size_t end){
+    for (size_t i = begin; i < end; i++){
+        sim->playerX[i] = sim->width / 2 - 5;
+        sim->score[i] = 0;
+        sim->reward[i] = 0;
+        sim->done[i] = 0;
+        sim->action[i] = 0;
+        for (size_t k = 0; k < BATCH_BULLETS; k++){
+            sim->bulletX[k * sim->num + i] = 0;
+            sim->bulletY[k * sim->num + i] = 0;
+        }
+        batchResetWave(sim, i);
+    }
+}
+
+#if USE_SSE2
+
+static inline __m128i select(__m128i mask, __m128i a, __m128i b){
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static void batchStepLanes(BatchSim* sim, size_t i){
+    const size_t num = sim->num;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+
+    //widen four action bytes to int32 lanes
+    uint32_t packed;
+    memcpy(&packed, sim->action + i, sizeof(packed));
+    __m128i action = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)packed), zero), zero);
+    __m128i left = _mm_cmpeq_epi32(_mm_and_si128(action, _mm_set1_epi32(BATCH_LEFT)), _mm_set1_epi32(BATCH_LEFT));
+    __m128i right = _mm_cmpeq_epi32(_mm_and_si128(action, _mm_set1_epi32(BATCH_RIGHT)), _mm_set1_epi32(BATCH_RIGHT));
+    __m128i fire = _mm_cmpeq_epi32(_mm_and_si128(action, _mm_set1_epi32(BATCH_FIRE)), _mm_set1_epi32(BATCH_FIRE));
+
+    //player movement, the masks are -1 when held so left - right is the step direction
+    __m128i playerX = _mm_load_si128((const __m128i*)(sim->playerX + i));
+    __m128i dir = _mm_slli_epi32(_mm_sub_epi32(left, right), 1);
+    playerX = _mm_add_epi32(playerX, dir);
+    __m128i maxX = _mm_set1_epi32(sim->width - sim->playerWidth);
+    playerX = select(_mm_cmpgt_epi32(playerX, maxX), maxX, playerX);
+    playerX = _mm_andnot_si128(_mm_cmplt_epi32(playerX, zero), playerX);
+    _mm_store_si128((__m128i*)(sim->playerX + i), playerX);
+
+    //bullet update
+    __m128i bulletX[BATCH_BULLETS], bulletY[BATCH_BULLETS], active[BATCH_BULLETS];
+    __m128i anyActive = zero;
+    __m128i height = _mm_set1_epi32(sim->height);
+    for (size_t k = 0; k < BATCH_BULLETS; k++){
+        bulletX[k] = _mm_load_si128((const __m128i*)(sim->bulletX + k * num + i));
+        bulletY[k] = _mm_add_epi32(_mm_load_si128((const __m128i*)(sim->bulletY + k * num + i)), _mm_set1_epi32(2));
+        active[k] = _mm_load_si128((const __m128i*)(sim->bulletActive + k * num + i));
+        active[k] = _mm_and_si128(active[k], _mm_cmplt_epi32(bulletY[k], height));
+        anyActive = _mm_or_si128(anyActive, active[k]);
+    }
+
+    //formation hit test, skipped entirely while no lane has a shot in flight
+    __m128i reward = zero;
+    __m128i kills = zero;
+    if (_mm_movemask_epi8(anyActive)){
+        __m128i bulletHeight = _mm_set1_epi32(sim->bulletHeight);
+        __m128i bulletTop[BATCH_BULLETS];
+        for (size_t k = 0; k < BATCH_BULLETS; k++){
+            bulletTop[k] = _mm_add_epi32(bulletY[k], bulletHeight);
+        }
+
+        for (size_t j = 0; j < sim->alienNum; j++){
+            int32_t* alivePtr = sim->alive + j * num + i;
+            __m128i alive = _mm_load_si128((const __m128i*)alivePtr);
+            if (!_mm_movemask_epi8(_mm_and_si128(alive, anyActive))) continue;
+
+            __m128i alienX = _mm_set1_epi32(sim->alienX[j]);
+            __m128i alienY = _mm_set1_epi32(sim->alienY[j]);
+            __m128i alienRight = _mm_set1_epi32(sim->alienRight[j]);
+            __m128i alienTop = _mm_set1_epi32(sim->alienTop[j]);
+            __m128i points = _mm_set1_epi32(sim->alienPoints[j]);
+
+            for (size_t k = 0; k < BATCH_BULLETS; k++){
+                __m128i inside = _mm_andnot_si128(_mm_cmplt_epi32(bulletX[k], alienX), _mm_cmplt_epi32(bulletX[k], alienRight));
+                inside = _mm_and_si128(inside, _mm_and_si128(_mm_cmpgt_epi32(bulletTop[k], alienY), _mm_cmplt_epi32(bulletY[k], alienTop)));
+                __m128i hit = _mm_and_si128(_mm_and_si128(active[k], alive), inside);
+
+                alive = _mm_andnot_si128(hit, alive);
+                active[k] = _mm_andnot_si128(hit, active[k]);
+                reward = _mm_add_epi32(reward, _mm_and_si128(hit, points));
+                kills = _mm_add_epi32(kills, _mm_and_si128(hit, one));
+            }
+            _mm_store_si128((__m128i*)alivePtr, alive);
+        }
+    }
+
+    //spawn a shot into the first free slot of each firing lane
+    __m128i spawnX = _mm_add_epi32(playerX, _mm_set1_epi32(sim->playerWidth / 2));
+    __m128i spawnY = _mm_set1_epi32(sim->playerY + sim->playerHeight);
+    for (size_t k = 0; k < BATCH_BULLETS; k++){
+        __m128i spawn = _mm_andnot_si128(active[k], fire);
+        fire = _mm_andnot_si128(spawn, fire);
+        active[k] = _mm_or_si128(active[k], spawn);
+        bulletX[k] = select(spawn, spawnX, bulletX[k]);
+        bulletY[k] = select(spawn, spawnY, bulletY[k]);
+
+        _mm_store_si128((__m128i*)(sim->bulletX + k * num + i), bulletX[k]);
+        _mm_store_si128((__m128i*)(sim->bulletY + k * num + i), bulletY[k]);
+        _mm_store_si128((__m128i*)(sim->bulletActive + k * num + i), active[k]);
+    }
+
+    __m128i score = _mm_add_epi32(_mm_load_si128((const __m128i*)(sim->score + i)), reward);
+    __m128i liveNum = _mm_sub_epi32(_mm_load_si128((const __m128i*)(sim->liveNum + i)), kills);
+    __m128i done = _mm_and_si128(_mm_cmpeq_epi32(liveNum, zero), one);
+    _mm_store_si128((__m128i*)(sim->score + i), score);
+    _mm_store_si128((__m128i*)(sim->reward + i), reward);
+    _mm_store_si128((__m128i*)(sim->liveNum + i), liveNum);
+    _mm_store_si128((__m128i*)(sim->done + i), done);
+}
+
+#endif
+
+//reference path for one instance, same rules as the vector lanes
+static void batchStepScalar(BatchSim* sim, size_t i){
+    const size_t num = sim->num;
+    uint8_t action = sim->action[i];
+
+    int32_t dir = 0;
+    if (action & BATCH_RIGHT) dir += 2;
+    if (action & BATCH_LEFT) dir -= 2;
+    int32_t playerX = sim->playerX[i] + dir;
+    if (playerX > sim->width - sim->playerWidth) playerX = sim->width - sim->playerWidth;
+    if (playerX < 0) playerX = 0;
+    sim->playerX[i] = playerX;
+
+    int32_t reward = 0;
+    int32_t kills = 0;
+    for (size_t k = 0; k < BATCH_BULLETS; k++){
+        size_t slot = k * num + i;
+        sim->bulletY[slot] += 2;
+        if (sim->bulletY[slot] >= sim->height) sim->bulletActive[slot] = 0;
+    }
+    for (size_t j = 0; j < sim->alienNum; j++){
+        int32_t& alive = sim->alive[j * num + i];
+        for (size_t k = 0; k < BATCH_BULLETS && alive; k++){
+            size_t slot = k * num + i;
+            if (!sim->bulletActive[slot]) continue;
+            int32_t x = sim->bulletX[slot];
+            int32_t y = sim->bulletY[slot];
+            if (x >= sim->alienX[j] && x < sim->alienRight[j] && y + sim->bulletHeight > sim->alienY[j] && y < sim->alienTop[j]){
+                alive = 0;
+                sim->bulletActive[slot] = 0;
+                reward += sim->alienPoints[j];
+                kills++;
+            }
+        }
+    }
+
+    if (action & BATCH_FIRE){
+        for (size_t k = 0; k < BATCH_BULLETS; k++){
+            size_t slot = k * num + i;
+            if (sim->bulletActive[slot]) continue;
+            sim->bulletActive[slot] = -1;
+            sim->bulletX[slot] = playerX + sim->playerWidth / 2;
+            sim->bulletY[slot] = sim->playerY + sim->playerHeight;
+            break;
+        }
+    }
+
+    sim->score[i] += reward;
+    sim->reward[i] = reward;
+    sim->liveNum[i] -= kills;
+    sim->done[i] = sim->liveNum[i] == 0;
+}
+
+void batchStep(BatchSim* sim, size_t begin, size_t end){
+    size_t i = begin;
+#if USE_SSE2
+    for (; i + 4 <= end; i += 4){
+        batchStepLanes(sim, i);
+    }
+#endif
+    for (; i < end; i++){
+        batchStepScalar(sim, i);
+    }
+
+    //finished waves restart, the done flag stays up for this step
+    for (i = begin; i < end; i++){
+        if (sim->done[i]) batchResetWave(sim, i);
+    }
+}
+
+double batchRun(BatchSim* sim, size_t ticks, size_t threads, uint64_t seed){
+    size_t blocks = sim->num / BATCH_BLOCK;
+    if (!threads) threads = 1;
+    if (threads > blocks) threads = blocks;
+
+    //every block draws its actions from its own stream, so the result is the same however
+    //the blocks are split across threads
+    auto worker = [sim, ticks, seed](size_t begin, size_t end){
+        vector<Rng> rngs((end - begin) / BATCH_BLOCK);
+        for (size_t b = 0; b < rngs.size(); b++){
+            rngSeed(&rngs[b], seed + begin / BATCH_BLOCK + b);
+        }
+        for (size_t t = 0; t < ticks; t++){
+            for (size_t i = begin; i < end; i += 4){
+                uint32_t bits = rngNext(&rngs[(i - begin) / BATCH_BLOCK]);
+                for (size_t lane = 0; lane < 4; lane++){
+                    sim->action[i + lane] = (uint8_t)((bits >> (8 * lane)) & 7);
+                }
+            }
+            batchStep(sim, begin, end);
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> pool;
+    for (size_t t = 0; t < threads; t++){
+        size_t begin = blocks * t / threads * BATCH_BLOCK;
+        size_t end = blocks * (t + 1) / threads * BATCH_BLOCK;
+        pool.emplace_back(worker, begin, end);
+    }
+    for (thread& t : pool){
+        t.join();
+    }
+
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
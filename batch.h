@@ -0,0 +1,58 @@
+#pragma once
+
+#include "assets.h"
+#include "config.h"
+
+//instances per cache line of int32 state, shards are always whole blocks
+#define BATCH_BLOCK 16
+#define BATCH_BULLETS 4
+
+enum BatchAction : uint8_t{
+    BATCH_LEFT = 1,
+    BATCH_RIGHT = 2,
+    BATCH_FIRE = 4
+};
+
+//many independent games in SoA form, one SIMD lane per game. the rules are the
+//player/bullet/formation core of gameStep with a static formation: the player
+//moves and fires up to BATCH_BULLETS shots, shots kill the first live alien
+//they overlap, and an instance restarts its wave once every alien is dead.
+//per-slot and per-alien arrays are laid out [slot * num + instance].
+struct BatchSim{
+    size_t num;
+    size_t alienNum;
+    int32_t width, height;
+    int32_t playerY, playerWidth, playerHeight;
+    int32_t bulletHeight;
+
+    int32_t* alienX;
+    int32_t* alienY;
+    int32_t* alienRight;
+    int32_t* alienTop;
+    int32_t* alienPoints;
+
+    int32_t* playerX;
+    int32_t* score;
+    int32_t* reward;
+    int32_t* done;
+    int32_t* liveNum;
+    int32_t* bulletX;
+    int32_t* bulletY;
+    int32_t* bulletActive;
+    int32_t* alive;
+    uint8_t* action;
+
+    uint8_t* memory;
+};
+
+//num is rounded up to a whole number of blocks
+void batchInit(BatchSim* sim, size_t num, const GameConfig& config, const Assets& assets);
+void batchFree(BatchSim* sim);
+void batchReset(BatchSim* sim, size_t begin, size_t end);
+
+//steps instances [begin, end) with the actions in sim->action, begin and end must be block aligned
+void batchStep(BatchSim* sim, size_t begin, size_t end);
+
+//steps every instance ticks times with random actions, sharded over threads. the actions
+//depend only on seed, not on the thread count. returns the wall time in seconds.
+double batchRun(BatchSim* sim, size_t ticks, size_t threads, uint64_t seed);
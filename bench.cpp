@@ -0,0 +1,385 @@
+//microbenchmarks for the raster and collision kernels, built as its own executable by
+//space-invaders-bench.vcxproj. results go to stdout, or --out FILE, as JSON. build with
+//NO_SIMD defined for the scalar fallbacks and compare the two files.
+
+#include "render.h"
+#include "bullets.h"
+#include "assets.h"
+#include "stats.h"
+#include "simd.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace std;
+
+struct BenchConfig{
+    int cpu;
+    size_t threads;
+    size_t samples;
+    double sampleSeconds;
+    const char* filter;
+    const char* outPath;
+};
+
+struct BenchResult{
+    string name;
+    string params;
+    string variant;
+    double nsPerOp;
+    double nsPerOpMin;
+    double bytesPerOp;
+};
+
+//runs ops operations, benchmarks keep their state in a closure
+struct Bench{
+    virtual ~Bench(){}
+    virtual void run(size_t ops) = 0;
+};
+
+template <typename F>
+struct BenchOf : Bench{
+    F body;
+
+    BenchOf(F body) : body(body){}
+    void run(size_t ops){
+        for (size_t i = 0; i < ops; i++){
+            body(i);
+        }
+    }
+};
+
+//keeps results alive so the compiler can't drop the work that produced them
+static volatile uint64_t benchSink;
+
+//pins the calling thread, a benchmark that migrates between cores mid sample is noise
+static bool benchPin(int cpu){
+    if (cpu < 0) return true;
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+//median of several samples, each long enough that timer resolution doesn't matter.
+//the op count per sample is calibrated first, which doubles as warmup
+static void benchRun(const BenchConfig& config, vector<BenchResult>* results, const char* name, const string& params,
+                     const char* variant, double bytesPerOp, Bench* bench){
+    string full = string(name) + "/" + params + "/" + variant;
+    if (config.filter && full.find(config.filter) == string::npos){
+        delete bench;
+        return;
+    }
+
+    size_t ops = 1;
+    for (;;){
+        uint64_t start = statsNow();
+        bench->run(ops);
+        double seconds = (statsNow() - start) * 1e-9;
+        if (seconds >= config.sampleSeconds / 4){
+            ops = (size_t)(ops * config.sampleSeconds / seconds) + 1;
+            break;
+        }
+        ops *= 2;
+    }
+
+    vector<double> samples;
+    for (size_t i = 0; i < config.samples; i++){
+        uint64_t start = statsNow();
+        bench->run(ops);
+        samples.push_back((double)(statsNow() - start) / ops);
+    }
+    delete bench;
+
+    vector<double> sorted = samples;
+    for (size_t i = 1; i < sorted.size(); i++){
+        for (size_t j = i; j > 0 && sorted[j] < sorted[j - 1]; j--){
+            swap(sorted[j], sorted[j - 1]);
+        }
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    result.variant = variant;
+    result.nsPerOp = sorted[sorted.size() / 2];
+    result.nsPerOpMin = sorted[0];
+    result.bytesPerOp = bytesPerOp;
+    results->push_back(result);
+    cerr << full << ": " << result.nsPerOp << " ns/op" << endl;
+}
+
+template <typename F>
+static void bench(const BenchConfig& config, vector<BenchResult>* results, const char* name, const string& params,
+                  const char* variant, double bytesPerOp, F body){
+    benchRun(config, results, name, params, variant, bytesPerOp, new BenchOf<F>(body));
+}
+
+//persistent workers that each run a slice of a job, so a threaded op costs a wakeup and
+//not a thread start. workers spin between jobs, the benchmark keeps them busy anyway
+struct BenchPool{
+    vector<thread> workers;
+    atomic<uint64_t> generation;
+    atomic<size_t> done;
+    atomic<bool> stop;
+    void (*job)(void* context, size_t slice, size_t sliceNum);
+    void* context;
+};
+
+static void benchWorker(BenchPool* pool, size_t slice, int cpu){
+    benchPin(cpu);
+    uint64_t seen = 0;
+    for (;;){
+        uint64_t generation;
+        while ((generation = pool->generation.load(memory_order_acquire)) == seen){
+            if (pool->stop.load(memory_order_relaxed)) return;
+            this_thread::yield();
+        }
+        seen = generation;
+        pool->job(pool->context, slice, pool->workers.size() + 1);
+        pool->done.fetch_add(1, memory_order_release);
+    }
+}
+
+static void benchPoolStart(BenchPool* pool, size_t threads, int cpu){
+    size_t cores = thread::hardware_concurrency() ? thread::hardware_concurrency() : 1;
+    pool->generation = 0;
+    pool->done = 0;
+    pool->stop = false;
+    for (size_t i = 1; i < threads; i++){
+        int core = cpu < 0 ? -1 : (int)((cpu + i) % cores);
+        pool->workers.push_back(thread(benchWorker, pool, i, core));
+    }
+}
+
+//the calling thread takes slice 0
+static void benchPoolRun(BenchPool* pool, void (*job)(void*, size_t, size_t), void* context){
+    pool->job = job;
+    pool->context = context;
+    pool->done.store(0, memory_order_relaxed);
+    pool->generation.fetch_add(1, memory_order_release);
+    job(context, 0, pool->workers.size() + 1);
+    while (pool->done.load(memory_order_acquire) < pool->workers.size()){}
+}
+
+static void benchPoolStop(BenchPool* pool){
+    pool->stop = true;
+    for (size_t i = 0; i < pool->workers.size(); i++){
+        pool->workers[i].join();
+    }
+    pool->workers.clear();
+}
+
+//clears the rows of one horizontal band of the buffer
+static void clearSlice(void* context, size_t slice, size_t sliceNum){
+    Buffer* buffer = (Buffer*)context;
+    size_t rows0 = buffer->height * slice / sliceNum;
+    size_t rows1 = buffer->height * (slice + 1) / sliceNum;
+    Buffer band = {buffer->width, rows1 - rows0, buffer->data + rows0 * buffer->width};
+    clearBuffer(&band, rgbToUint32(0, 0, 0));
+}
+
+static void benchRaster(const BenchConfig& config, vector<BenchResult>* results, const Assets& assets){
+    const size_t sizes[][2] = {{224, 256}, {448, 512}, {1920, 1080}};
+
+    BenchPool pool;
+    benchPoolStart(&pool, config.threads, config.cpu);
+
+    for (size_t s = 0; s < 3; s++){
+        Buffer buffer;
+        buffer.width = sizes[s][0];
+        buffer.height = sizes[s][1];
+        vector<uint32_t> pixels(buffer.width * buffer.height);
+        buffer.data = pixels.data();
+        string params = to_string(buffer.width) + "x" + to_string(buffer.height);
+        double bytes = (double)pixels.size() * sizeof(uint32_t);
+
+        bench(config, results, "clearBuffer", params, "single", bytes, [&](size_t){
+            clearBuffer(&buffer, rgbToUint32(0, 0, 0));
+        });
+        if (config.threads > 1){
+            string variant = "threads" + to_string(config.threads);
+            bench(config, results, "clearBuffer", params, variant.c_str(), bytes, [&](size_t){
+                benchPoolRun(&pool, clearSlice, &buffer);
+            });
+        }
+    }
+    benchPoolStop(&pool);
+
+    //sprites walk across a game sized buffer so that clipping and cache behaviour are typical
+    Buffer buffer;
+    buffer.width = 224;
+    buffer.height = 256;
+    vector<uint32_t> pixels(buffer.width * buffer.height);
+    buffer.data = pixels.data();
+    uint32_t colour = rgbToUint32(128, 0, 0);
+
+    struct{ const char* name; const Sprite* sprite; } sprites[] = {
+        {"bullet", &assets.bulletSprite},
+        {"alienA", &assets.alienSprites[0]},
+        {"alienC", &assets.alienSprites[4]},
+        {"death", &assets.alienDeathSprite},
+        {"player", &assets.playerSprite}
+    };
+    for (size_t s = 0; s < sizeof(sprites) / sizeof(sprites[0]); s++){
+        const Sprite& sprite = *sprites[s].sprite;
+        string params = string(sprites[s].name) + "-" + to_string(sprite.width) + "x" + to_string(sprite.height);
+        bench(config, results, "drawSprite", params, "single", (double)sprite.width * sprite.height * sizeof(uint32_t), [&](size_t i){
+            drawSprite(&buffer, sprite, (i * 37) % buffer.width, (i * 101) % buffer.height, colour);
+        });
+    }
+
+    const char* texts[] = {"00", "SCORE", "CREDIT 00", "GAME OVER PRESS START"};
+    for (size_t t = 0; t < 4; t++){
+        const char* text = texts[t];
+        size_t length = strlen(text);
+        bench(config, results, "drawText", to_string(length) + "chars", "single",
+              (double)length * assets.textSheet.width * assets.textSheet.height * sizeof(uint32_t), [&](size_t i){
+            drawText(&buffer, assets.textSheet, text, (i * 7) % 64, (i * 13) % 240, colour);
+        });
+    }
+
+    const size_t numbers[] = {7, 1230, 4294967295u};
+    for (size_t n = 0; n < 3; n++){
+        size_t number = numbers[n];
+        size_t digits = to_string(number).size();
+        bench(config, results, "drawNumber", to_string(digits) + "digits", "single",
+              (double)digits * assets.numberSheet.width * assets.numberSheet.height * sizeof(uint32_t), [&](size_t i){
+            drawNumber(&buffer, assets.numberSheet, number + (i & 1), (i * 7) % 64, (i * 13) % 240, colour);
+        });
+    }
+    benchSink = pixels[pixels.size() / 2];
+}
+
+static void benchCollision(const BenchConfig& config, vector<BenchResult>* results, const Assets& assets){
+    //one op tests every pair, about half of them overlap
+    const size_t pairCounts[] = {64, 1024, 16384};
+    for (size_t p = 0; p < 3; p++){
+        size_t pairNum = pairCounts[p];
+        vector<uint32_t> positions(pairNum * 4);
+        uint32_t state = 12345;
+        for (size_t i = 0; i < positions.size(); i++){
+            state = state * 1664525u + 1013904223u;
+            positions[i] = (state >> 16) % 24;
+        }
+        bench(config, results, "spriteOverlap", to_string(pairNum) + "pairs", "single", (double)pairNum * 4 * sizeof(uint32_t), [&](size_t){
+            uint64_t hits = 0;
+            for (size_t i = 0; i < pairNum; i++){
+                const uint32_t* pos = &positions[4 * i];
+                hits += spriteOverlap(assets.bulletSprite, pos[0], pos[1], assets.alienSprites[0], pos[2], pos[3]);
+            }
+            benchSink = hits;
+        });
+    }
+
+    //bullets move up and down inside bounds they never reach, so the pool stays full
+    const size_t bulletCounts[] = {16, 256, 4096, 65536};
+    for (size_t b = 0; b < 4; b++){
+        size_t count = bulletCounts[b];
+        Arena arena;
+        BulletPool pool;
+        arenaInit(&arena, nullptr, 0);
+        bulletPoolInit(&pool, &arena, count);
+        vector<uint8_t> block(arena.used + 16);
+        arenaInit(&arena, block.data(), block.size());
+        bulletPoolInit(&pool, &arena, count);
+        for (size_t i = 0; i < count; i++){
+            bulletSpawn(&pool, (int32_t)i, 0, (i & 1) ? 1 : -1, 0);
+        }
+        //reads y and dir, writes y
+        bench(config, results, "bulletPoolUpdate", to_string(count) + "bullets", "single", (double)count * 3 * sizeof(int32_t), [&](size_t){
+            bulletPoolUpdate(&pool, -(1 << 30), 1 << 30);
+        });
+        benchSink = pool.y[0];
+    }
+}
+
+static void benchWrite(const BenchConfig& config, const vector<BenchResult>& results, FILE* file){
+    fprintf(file, "{\n  \"simd\": \"%s\",\n  \"cpu\": %d,\n  \"threads\": %zu,\n  \"samples\": %zu,\n  \"results\": [\n",
+            USE_SSE2 ? "sse2" : "scalar", config.cpu, config.threads, config.samples);
+    for (size_t i = 0; i < results.size(); i++){
+        const BenchResult& result = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"params\": \"%s\", \"variant\": \"%s\", \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"bytes_per_op\": %.0f, \"gb_per_s\": %.3f}%s\n",
+                result.name.c_str(), result.params.c_str(), result.variant.c_str(), result.nsPerOp, result.nsPerOpMin, result.bytesPerOp,
+                result.bytesPerOp / result.nsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char** argv){
+    BenchConfig config;
+    config.cpu = 0;
+    config.threads = 4;
+    config.samples = 9;
+    config.sampleSeconds = 0.02;
+    config.filter = nullptr;
+    config.outPath = nullptr;
+
+    for (int i = 1; i < argc; i++){
+        const char* arg = argv[i];
+        if (i + 1 >= argc){
+            cout << "usage: space-invaders-bench [--cpu N] [--threads N] [--samples N] [--sample-ms N] [--filter TEXT] [--out FILE]\n"
+                    "  --cpu N       pin to core N, threaded variants use the cores after it, -1 doesn't pin\n"
+                    "  --filter TEXT only run benchmarks whose name/params/variant contains TEXT" << endl;
+            return -1;
+        }
+        const char* value = argv[++i];
+        if (!strcmp(arg, "--cpu")) config.cpu = atoi(value);
+        else if (!strcmp(arg, "--threads")) config.threads = (size_t)atoi(value);
+        else if (!strcmp(arg, "--samples")) config.samples = (size_t)atoi(value);
+        else if (!strcmp(arg, "--sample-ms")) config.sampleSeconds = atof(value) * 1e-3;
+        else if (!strcmp(arg, "--filter")) config.filter = value;
+        else if (!strcmp(arg, "--out")) config.outPath = value;
+        else {
+            cout << "Unknown option " << arg << endl;
+            return -1;
+        }
+    }
+    //spinning workers sharing a core measure the scheduler, not the kernel
+    size_t cores = thread::hardware_concurrency();
+    if (!config.threads) config.threads = 1;
+    if (cores && config.threads > cores){
+        cerr << "only " << cores << " cores, threaded variants use " << cores << " threads" << endl;
+        config.threads = cores;
+    }
+    if (!config.samples) config.samples = 1;
+    if (!benchPin(config.cpu)) cerr << "Failed to pin to cpu " << config.cpu << ", results will be noisier" << endl;
+
+    Assets assets;
+    assetsInit(&assets);
+
+    vector<BenchResult> results;
+    benchRaster(config, &results, assets);
+    benchCollision(config, &results, assets);
+
+    FILE* file = config.outPath ? fopen(config.outPath, "w") : stdout;
+    if (!file){
+        cout << "Failed to create " << config.outPath << endl;
+        assetsFree(&assets);
+        return -1;
+    }
+    benchWrite(config, results, file);
+    if (file != stdout) fclose(file);
+
+    assetsFree(&assets);
+    return 0;
+}
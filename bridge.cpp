@@ -0,0 +1,203 @@
+#include "bridge.h"
+#include "simd.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+using namespace std;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the handshake needs lock-free atomics in shared memory");
+
+//which side waits on which event, the futex path wakes everyone and lets them recheck
+enum BridgeSide{
+    BRIDGE_HOST = 0,
+    BRIDGE_AGENT = 1
+};
+
+static size_t alignLine(size_t size){
+    return (size + 63) & ~(size_t)63;
+}
+
+static void bridgeWait(Bridge* bridge, uint32_t old, int side){
+    BridgeHeader* header = bridge->header;
+    for (uint32_t i = 0; i < header->spin; i++){
+        if (header->seq.load(memory_order_acquire) != old) return;
+        cpuRelax();
+    }
+
+#if !defined(_WIN32)
+    (void)side;
+#endif
+
+    //registering before the final check pairs with the load of sleepers in bridgeSignal,
+    //so either the waker sees us or we see its store
+    header->sleepers.fetch_add(1);
+    while (header->seq.load() == old){
+#if defined(_WIN32)
+        WaitForSingleObject((HANDLE)bridge->events[side], INFINITE);
+#elif defined(__linux__)
+        syscall(SYS_futex, (uint32_t*)&header->seq, FUTEX_WAIT, old, nullptr, nullptr, 0);
+#else
+        sched_yield();
+#endif
+    }
+    header->sleepers.fetch_sub(1);
+}
+
+static void bridgeSignal(Bridge* bridge, uint32_t seq, int side){
+    BridgeHeader* header = bridge->header;
+    header->seq.store(seq);
+    if (!header->sleepers.load()) return;
+#if defined(_WIN32)
+    SetEvent((HANDLE)bridge->events[side]);
+#else
+    (void)side;
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)&header->seq, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+#endif
+}
+
+static bool bridgeMap(Bridge* bridge, const char* name, size_t size, bool create){
+    memset(bridge, 0, sizeof(Bridge));
+    bool ok = create ? sharedCreate(&bridge->shared, name, size) : sharedOpen(&bridge->shared, name, sizeof(BridgeHeader));
+    if (!ok) return false;
+
+#ifdef _WIN32
+    char path[96];
+    for (int i = 0; i < 2; i++){
+        snprintf(path, sizeof(path), "%s-%d", bridge->shared.name, i);
+        bridge->events[i] = create ? CreateEventA(NULL, FALSE, FALSE, path) : OpenEventA(EVENT_ALL_ACCESS, FALSE, path);
+    }
+    if (!bridge->events[0] || !bridge->events[1]){
+        cout << "Failed to open events for " << bridge->shared.name << endl;
+        bridgeClose(bridge);
+        return false;
+    }
+#endif
+
+    bridge->memory = bridge->shared.memory;
+    bridge->header = (BridgeHeader*)bridge->memory;
+    return true;
+}
+
+bool bridgeCreate(Bridge* bridge, const char* name, const Game& game, uint32_t spin){
+    uint32_t bulletMax = (uint32_t)game.bullets.capacity;
+    size_t aliveOffset = alignLine(sizeof(BridgeHeader));
+    size_t bulletOffset = aliveOffset + alignLine((game.alienNum + 63) / 64 * sizeof(uint64_t));
+    size_t frameOffset = bulletOffset + alignLine(3 * bulletMax * sizeof(int32_t));
+    size_t size = frameOffset + game.width * game.height * sizeof(uint32_t);
+
+    if (!bridgeMap(bridge, name, size, true)) return false;
+
+    BridgeHeader* header = bridge->header;
+    memset(bridge->memory, 0, size);
+    header->version = BRIDGE_VERSION;
+    header->size = size;
+    header->width = (uint32_t)game.width;
+    header->height = (uint32_t)game.height;
+    header->alienNum = (uint32_t)game.alienNum;
+    header->bulletMax = bulletMax;
+    header->aliveOffset = aliveOffset;
+    header->bulletOffset = bulletOffset;
+    header->frameOffset = frameOffset;
+    //spinning only pays off when the other side can run at the same time
+    header->spin = thread::hardware_concurrency() > 1 ? spin : 0;
+
+    //an action is pending until the first publish, so agents can't attach early
+    bridge->seq = 0xFFFFFFFFu;
+    header->seq.store(bridge->seq);
+    header->sleepers.store(0);
+
+    atomic_thread_fence(memory_order_release);
+    header->magic = BRIDGE_MAGIC;
+    return true;
+}
+
+bool bridgeOpen(Bridge* bridge, const char* name){
+    if (!bridgeMap(bridge, name, 0, false)) return false;
+
+    BridgeHeader* header = bridge->header;
+    if (header->magic != BRIDGE_MAGIC || header->version != BRIDGE_VERSION || header->size > bridge->shared.size){
+        cout << "Shared memory " << bridge->shared.name << " is not a version " << BRIDGE_VERSION << " bridge" << endl;
+        bridgeClose(bridge);
+        return false;
+    }
+
+    bridge->seq = header->seq.load();
+    if (bridge->seq & 1){
+        cout << "Bridge " << bridge->shared.name << " is busy" << endl;
+        bridgeClose(bridge);
+        return false;
+    }
+    return true;
+}
+
+void bridgeClose(Bridge* bridge){
+#ifdef _WIN32
+    for (int i = 0; i < 2; i++){
+        if (bridge->events[i]) CloseHandle((HANDLE)bridge->events[i]);
+    }
+#endif
+    sharedClose(&bridge->shared);
+    memset(bridge, 0, sizeof(Bridge));
+}
+
+uint32_t bridgeWaitAction(Bridge* bridge){
+    bridgeWait(bridge, bridge->seq, BRIDGE_HOST);
+    bridge->seq = bridge->header->seq.load(memory_order_acquire);
+    return bridge->header->action;
+}
+
+void bridgePublish(Bridge* bridge, const Game& game, int32_t reward){
+    BridgeHeader* header = bridge->header;
+    BridgeState& state = header->state;
+    state.tick = game.tick;
+    state.score = game.score;
+    state.reward = reward;
+    state.done = gameOver(game);
+    state.lives = (uint32_t)game.player.lives;
+    state.playerAlive = game.player.alive;
+    state.playerX = (int32_t)game.player.x;
+    state.liveNum = (uint32_t)game.formation.liveNum;
+
+    //bulletMax is the fixed pool capacity of the game the bridge was sized for, the clamp
+    //only matters if a different game is published
+    size_t bulletNum = game.bullets.count < header->bulletMax ? game.bullets.count : header->bulletMax;
+    int32_t* bullets = bridgeBullets(*bridge);
+    memcpy(bullets, game.bullets.x, bulletNum * sizeof(int32_t));
+    memcpy(bullets + header->bulletMax, game.bullets.y, bulletNum * sizeof(int32_t));
+    memcpy(bullets + 2 * header->bulletMax, game.bullets.dir, bulletNum * sizeof(int32_t));
+    state.bulletNum = (uint32_t)bulletNum;
+
+    memcpy(bridgeAlive(*bridge), game.formation.aliveBits, (game.alienNum + 63) / 64 * sizeof(uint64_t));
+
+    bridgeSignal(bridge, ++bridge->seq, BRIDGE_AGENT);
+}
+
+void bridgeStep(Bridge* bridge, uint32_t action){
+    bridge->header->action = action;
+    bridgeSignal(bridge, ++bridge->seq, BRIDGE_HOST);
+    bridgeWait(bridge, bridge->seq, BRIDGE_AGENT);
+    bridge->seq = bridge->header->seq.load(memory_order_acquire);
+}
+
+void bridgeQuit(Bridge* bridge){
+    bridge->header->action = BRIDGE_QUIT;
+    bridgeSignal(bridge, ++bridge->seq, BRIDGE_HOST);
+}
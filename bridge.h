@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "game.h"
+#include "shm.h"
+
+#define BRIDGE_MAGIC 0x52424953u //"SIBR"
+#define BRIDGE_VERSION 1
+#define BRIDGE_SPIN 4096
+
+//action word flags, the low bits are the EnvAction mask
+enum BridgeFlag : uint32_t{
+    BRIDGE_DRAW = 8,   //render this tick into the shared frame
+    BRIDGE_RESET = 16, //restart with header->seed instead of stepping
+    BRIDGE_QUIT = 32   //host exits
+};
+
+struct BridgeState{
+    uint64_t tick;
+    uint64_t score;
+    int32_t reward;
+    uint32_t done;
+    uint32_t lives;
+    uint32_t playerAlive;
+    int32_t playerX;
+    uint32_t liveNum;
+    uint32_t bulletNum;
+};
+
+//start of the shared region. seq is even while the state belongs to the agent and
+//odd while the action belongs to the host, each side spins on it and only falls
+//back to a futex once spin runs out. the waker skips the wake syscall unless the
+//other side has registered itself in sleepers.
+struct BridgeHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint32_t width, height;
+    uint32_t alienNum;
+    uint32_t bulletMax;
+    uint64_t aliveOffset;
+    uint64_t bulletOffset;
+    uint64_t frameOffset;
+    uint32_t spin;
+
+    alignas(64) std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> sleepers;
+
+    alignas(64) uint32_t action;
+    uint64_t seed;
+
+    alignas(64) BridgeState state;
+};
+
+struct Bridge{
+    BridgeHeader* header;
+    uint8_t* memory;
+    SharedMemory shared;
+    uint32_t seq;
+#ifdef _WIN32
+    void* events[2];
+#endif
+};
+
+//game side, creates and maps the region sized for the game
+bool bridgeCreate(Bridge* bridge, const char* name, const Game& game, uint32_t spin);
+
+//agent side, maps a region created by a running host
+bool bridgeOpen(Bridge* bridge, const char* name);
+void bridgeClose(Bridge* bridge);
+
+//host: blocks until the agent has posted an action
+uint32_t bridgeWaitAction(Bridge* bridge);
+
+//host: fills the state block from the game and hands it to the agent
+void bridgePublish(Bridge* bridge, const Game& game, int32_t reward);
+
+//agent: posts an action and blocks until the host has published the next state
+void bridgeStep(Bridge* bridge, uint32_t action);
+
+//agent: tells the host to exit, does not wait for a reply
+void bridgeQuit(Bridge* bridge);
+
+inline uint32_t* bridgeFrame(const Bridge& bridge){
+    return (uint32_t*)(bridge.memory + bridge.header->frameOffset);
+}
+
+inline uint64_t* bridgeAlive(const Bridge& bridge){
+    return (uint64_t*)(bridge.memory + bridge.header->aliveOffset);
+}
+
+//bullet x, y and dir arrays of bulletMax entries each, back to back
+inline int32_t* bridgeBullets(const Bridge& bridge){
+    return (int32_t*)(bridge.memory + bridge.header->bulletOffset);
+}
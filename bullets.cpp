@@ -0,0 +1,123 @@
+#include "bullets.h"
+#include "simd.h"
+
+#include <cstring>
+
+void bulletPoolInit(BulletPool* pool, Arena* arena, size_t capacity){
+    memset(pool, 0, sizeof(BulletPool));
+    pool->capacity = capacity ? capacity : 1;
+    pool->x = arenaAlloc<int32_t>(arena, pool->capacity);
+    pool->y = arenaAlloc<int32_t>(arena, pool->capacity);
+    pool->dir = arenaAlloc<int32_t>(arena, pool->capacity);
+    pool->owner = arenaAlloc<uint8_t>(arena, pool->capacity);
+    pool->dead = arenaAlloc<uint8_t>(arena, pool->capacity);
+    pool->slotOf = arenaAlloc<uint32_t>(arena, pool->capacity);
+    pool->denseOf = arenaAlloc<uint32_t>(arena, pool->capacity);
+    pool->generation = arenaAlloc<uint32_t>(arena, pool->capacity);
+    if (arenaMeasuring(*arena)) return;
+
+    for (size_t i = 0; i < pool->capacity; i++){
+        pool->slotOf[i] = (uint32_t)i;
+        pool->denseOf[i] = (uint32_t)i;
+        pool->generation[i] = 0;
+    }
+}
+
+void bulletPoolClear(BulletPool* pool){
+    for (size_t i = 0; i < pool->count; i++){
+        pool->generation[pool->slotOf[i]]++;
+    }
+    pool->count = 0;
+    pool->killNum = 0;
+}
+
+BulletHandle bulletSpawn(BulletPool* pool, int32_t x, int32_t y, int32_t dir, uint8_t owner){
+    if (pool->count == pool->capacity){
+        BulletHandle none = {BULLET_NONE, 0};
+        return none;
+    }
+
+    size_t i = pool->count++;
+    uint32_t slot = pool->slotOf[i];
+    pool->denseOf[slot] = (uint32_t)i;
+    pool->x[i] = x;
+    pool->y[i] = y;
+    pool->dir[i] = dir;
+    pool->owner[i] = owner;
+    pool->dead[i] = 0;
+
+    BulletHandle handle;
+    handle.slot = slot;
+    handle.generation = pool->generation[slot];
+    return handle;
+}
+
+void bulletKill(BulletPool* pool, size_t i){
+    if (pool->dead[i]) return;
+    pool->dead[i] = 1;
+    pool->killNum++;
+}
+
+bool bulletFind(const BulletPool& pool, BulletHandle handle, size_t* index){
+    if (handle.slot >= pool.capacity || pool.generation[handle.slot] != handle.generation) return false;
+
+    size_t i = pool.denseOf[handle.slot];
+    if (i >= pool.count || pool.dead[i]) return false;
+
+    *index = i;
+    return true;
+}
+
+void bulletPoolUpdate(BulletPool* pool, int32_t minY, int32_t maxY){
+    size_t i = 0;
+
+#if USE_SSE2
+    __m128i lo = _mm_set1_epi32(minY);
+    __m128i hi = _mm_set1_epi32(maxY - 1);
+    for (; i + 4 <= pool->count; i += 4){
+        __m128i y = _mm_loadu_si128((const __m128i*)(pool->y + i));
+        __m128i dir = _mm_loadu_si128((const __m128i*)(pool->dir + i));
+        y = _mm_add_epi32(y, dir);
+        _mm_storeu_si128((__m128i*)(pool->y + i), y);
+
+        __m128i out = _mm_or_si128(_mm_cmplt_epi32(y, lo), _mm_cmpgt_epi32(y, hi));
+        uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(out));
+        while (mask){
+            bulletKill(pool, i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i < pool->count; i++){
+        pool->y[i] += pool->dir[i];
+        if (pool->y[i] < minY || pool->y[i] >= maxY) bulletKill(pool, i);
+    }
+}
+
+void bulletPoolCompact(BulletPool* pool){
+    if (!pool->killNum) return;
+
+    //walking backwards means the last bullet is never a pending kill when it gets swapped in
+    for (size_t i = pool->count; i-- > 0;){
+        if (!pool->dead[i]) continue;
+
+        size_t last = --pool->count;
+        uint32_t slot = pool->slotOf[i];
+        uint32_t lastSlot = pool->slotOf[last];
+
+        pool->x[i] = pool->x[last];
+        pool->y[i] = pool->y[last];
+        pool->dir[i] = pool->dir[last];
+        pool->owner[i] = pool->owner[last];
+        pool->dead[i] = pool->dead[last];
+
+        pool->slotOf[i] = lastSlot;
+        pool->denseOf[lastSlot] = (uint32_t)i;
+        pool->slotOf[last] = slot;
+        pool->denseOf[slot] = (uint32_t)last;
+        pool->generation[slot]++;
+    }
+
+    pool->killNum = 0;
+}
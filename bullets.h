@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "arena.h"
+
+//default --bullets, the pool is raised to the most shots a config can have in flight
+#define BULLET_POOL_CAPACITY 128
+#define BULLET_NONE 0xFFFFFFFFu
+
+//refers to a bullet across frames, stale once the bullet is removed
+struct BulletHandle{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+//bullets are packed at the front of the SoA arrays, [0, count) are live.
+//slotOf is a permutation of every slot, so [count, capacity) doubles as the free list.
+//the arrays live in the owner's arena, so the capacity is fixed.
+struct BulletPool{
+    size_t capacity;
+    size_t count;
+    size_t killNum;
+    RelPtr<int32_t> x;
+    RelPtr<int32_t> y;
+    RelPtr<int32_t> dir;
+    RelPtr<uint8_t> owner;
+    RelPtr<uint8_t> dead;
+    RelPtr<uint32_t> slotOf;
+    RelPtr<uint32_t> denseOf;
+    RelPtr<uint32_t> generation;
+};
+
+void bulletPoolInit(BulletPool* pool, Arena* arena, size_t capacity);
+void bulletPoolClear(BulletPool* pool);
+
+//owner says whose score a hit counts towards. a full pool drops the shot and
+//returns a handle with slot BULLET_NONE
+BulletHandle bulletSpawn(BulletPool* pool, int32_t x, int32_t y, int32_t dir, uint8_t owner);
+
+//marks a bullet for removal at the next compaction, killing it twice is a no-op
+void bulletKill(BulletPool* pool, size_t i);
+
+//dense index of a live bullet, or false if the handle is stale
+bool bulletFind(const BulletPool& pool, BulletHandle handle, size_t* index);
+
+//moves every bullet by its direction and kills the ones that left [minY, maxY)
+void bulletPoolUpdate(BulletPool* pool, int32_t minY, int32_t maxY);
+
+//removes killed bullets, call once at the end of the tick
+void bulletPoolCompact(BulletPool* pool);
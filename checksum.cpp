@@ -0,0 +1,322 @@
+#include "checksum.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+const char* stateFieldNames[STATE_FIELD_COUNT] = {
+    "scalars",
+    "player",
+    "rng",
+    "aliens",
+    "formation",
+    "animations",
+    "bullets",
+    "timers",
+    "shields",
+    "bots"
+};
+
+static const uint64_t hashPrime1 = 0x9E3779B185EBCA87ull;
+static const uint64_t hashPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+static inline uint64_t hashMix(uint64_t h, uint64_t value){
+    h ^= value * hashPrime2;
+    h = (h << 31) | (h >> 33);
+    return h * hashPrime1;
+}
+
+static inline uint64_t hashFinish(uint64_t h){
+    h ^= h >> 33;
+    h *= hashPrime2;
+    h ^= h >> 29;
+    h *= hashPrime1;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed){
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t h = seed ^ (size * hashPrime1);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        h = hashMix(h, word);
+    }
+    if (i < size){
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, size - i);
+        h = hashMix(h, word);
+    }
+    return hashFinish(h);
+}
+
+static uint64_t hashAliens(const Game& game){
+    //Alien has padding, so the fields are mixed one by one
+    uint64_t h = game.alienNum;
+    for (size_t i = 0; i < game.alienNum; i++){
+        const Alien& alien = game.aliens[i];
+        h = hashMix(h, alien.x);
+        h = hashMix(h, alien.y);
+        h = hashMix(h, alien.type);
+    }
+    return hashFinish(h);
+}
+
+static uint64_t hashFormation(const Formation& formation){
+    uint64_t h = hashBytes(formation.aliveBits, (formation.rows * formation.cols + 63) / 64 * sizeof(uint64_t), formation.liveNum);
+    h = hashMix(h, formation.left);
+    h = hashMix(h, formation.right);
+    h = hashMix(h, formation.bottom);
+    //the live column list in its order and the column bottoms pick the alien shooters
+    h = hashBytes(formation.liveCols, formation.liveColNum * sizeof(uint32_t), h);
+    h = hashBytes(formation.colBottom, formation.cols * sizeof(uint32_t), h);
+    h = hashMix(h, formation.head);
+    h = hashMix(h, formation.cursor);
+    h = hashMix(h, (uint32_t)formation.offsetX);
+    h = hashMix(h, (uint32_t)formation.offsetY);
+    h = hashMix(h, (uint32_t)formation.stepX);
+    h = hashMix(h, (uint32_t)formation.moveX);
+    h = hashMix(h, (uint32_t)formation.moveY);
+    h = hashMix(h, formation.invaded);
+    return hashFinish(h);
+}
+
+static uint64_t hashAnimations(const AnimationSystem& animations){
+    size_t size = animations.count * sizeof(uint16_t);
+    uint64_t h = hashBytes(animations.type, size, animations.count);
+    h = hashBytes(animations.counter, size, h);
+    return hashBytes(animations.frame, size, h);
+}
+
+//owners only matter when there is a rival to credit
+static uint64_t hashBullets(const BulletPool& bullets, bool versus){
+    size_t size = bullets.count * sizeof(int32_t);
+    uint64_t h = hashBytes(bullets.x, size, bullets.count);
+    h = hashBytes(bullets.y, size, h);
+    if (versus) h = hashBytes(bullets.owner, bullets.count, h);
+    return hashBytes(bullets.dir, size, h);
+}
+
+//pending timers in wheel order, which is itself deterministic
+static uint64_t hashTimers(const TimerWheel& timers){
+    uint64_t h = hashMix(timers.now, timers.activeNum);
+    for (size_t i = 0; i < TIMER_BUCKETS; i++){
+        for (uint32_t node = timers.heads[i]; node != TIMER_NONE; node = timers.next[node]){
+            h = hashMix(h, timers.expiry[node]);
+            h = hashMix(h, ((uint64_t)timers.kind[node] << 32) | timers.payload[node]);
+        }
+    }
+    return hashFinish(h);
+}
+
+static uint64_t hashShields(const Game& game){
+    uint64_t h = 0;
+    for (size_t i = 0; i < SHIELD_COUNT; i++){
+        const Shield& shield = game.shields[i];
+        h = hashMix(h, ((uint64_t)(uint32_t)shield.x << 32) | (uint32_t)shield.y);
+        h = hashBytes(shield.rows, sizeof(shield.rows), h);
+    }
+    return h;
+}
+
+static uint64_t hashBots(const Game& game){
+    uint64_t h = game.botNum;
+    for (size_t i = 0; i < game.botNum; i++){
+        const Bot& bot = game.bots[i];
+        h = hashMix(h, ((uint64_t)(uint32_t)bot.x << 32) | (uint32_t)bot.dir);
+        h = hashMix(h, bot.cooldown);
+    }
+    return hashFinish(h);
+}
+
+void checksumGame(const Game& game, const Buffer* buffer, ChecksumRecord* record){
+    uint64_t* fields = record->fields;
+    fields[STATE_SCALARS] = hashFinish(hashMix(hashMix(hashMix(0, game.tick), game.score), game.fireInterval));
+    fields[STATE_PLAYER] = hashFinish(hashMix(hashMix(hashMix(hashMix(0, game.player.x), game.player.y), game.player.lives), game.player.alive));
+    //the idle rival of a single player game is left out, so older checksum files still match
+    if (game.versus){
+        uint64_t h = hashMix(hashMix(hashMix(hashMix(fields[STATE_PLAYER], game.rival.x), game.rival.lives), game.rival.alive), game.rivalScore);
+        fields[STATE_PLAYER] = hashFinish(h);
+    }
+    fields[STATE_RNG] = hashFinish(hashMix(0, game.rng.state));
+    fields[STATE_ALIENS] = hashAliens(game);
+    fields[STATE_FORMATION] = hashFormation(game.formation);
+    fields[STATE_ANIMATIONS] = hashAnimations(game.animations);
+    fields[STATE_BULLETS] = hashBullets(game.bullets, game.versus);
+    fields[STATE_TIMERS] = hashTimers(game.timers);
+    fields[STATE_SHIELDS] = hashShields(game);
+    fields[STATE_BOTS] = hashBots(game);
+
+    record->state = hashBytes(fields, sizeof(record->fields), 0);
+    record->buffer = buffer ? hashBytes(buffer->data, buffer->width * buffer->height * sizeof(uint32_t), 0) : 0;
+}
+
+bool checksumCreate(ChecksumWriter* writer, const char* path, bool frames){
+    memset(writer, 0, sizeof(ChecksumWriter));
+    writer->file = fopen(path, "wb");
+    if (!writer->file){
+        cout << "Failed to create checksums " << path << endl;
+        return false;
+    }
+
+    writer->header.magic = CHECKSUM_MAGIC;
+    writer->header.version = CHECKSUM_VERSION;
+    writer->header.fieldNum = STATE_FIELD_COUNT;
+    writer->header.frames = frames;
+    fwrite(&writer->header, sizeof(ChecksumHeader), 1, writer->file);
+    return true;
+}
+
+void checksumWrite(ChecksumWriter* writer, const ChecksumRecord& record){
+    fwrite(&record, sizeof(ChecksumRecord), 1, writer->file);
+    writer->header.tickNum++;
+}
+
+bool checksumFinish(ChecksumWriter* writer){
+    fseek(writer->file, 0, SEEK_SET);
+    fwrite(&writer->header, sizeof(ChecksumHeader), 1, writer->file);
+
+    bool ok = !ferror(writer->file);
+    if (fclose(writer->file) != 0) ok = false;
+    writer->file = nullptr;
+    if (!ok) cout << "Failed to write checksums" << endl;
+    return ok;
+}
+
+bool checksumOpen(ChecksumReader* reader, const char* path){
+    memset(reader, 0, sizeof(ChecksumReader));
+    if (!mapFile(&reader->file, path)) return false;
+
+    const ChecksumHeader* header = (const ChecksumHeader*)reader->file.data;
+    if (reader->file.size < sizeof(ChecksumHeader) || header->magic != CHECKSUM_MAGIC || header->version != CHECKSUM_VERSION ||
+        header->fieldNum != STATE_FIELD_COUNT || reader->file.size < sizeof(ChecksumHeader) + header->tickNum * sizeof(ChecksumRecord)){
+        cout << path << " is not a version " << CHECKSUM_VERSION << " checksum file" << endl;
+        checksumClose(reader);
+        return false;
+    }
+
+    reader->header = header;
+    reader->records = (const ChecksumRecord*)(reader->file.data + sizeof(ChecksumHeader));
+    return true;
+}
+
+void checksumClose(ChecksumReader* reader){
+    unmapFile(&reader->file);
+    memset(reader, 0, sizeof(ChecksumReader));
+}
+
+bool checksumVerify(ChecksumReader* reader, uint64_t tick, const ChecksumRecord& record){
+    if (tick >= reader->header->tickNum) return true;
+
+    const ChecksumRecord& expected = reader->records[tick];
+    bool frameMatch = !reader->header->frames || expected.buffer == record.buffer;
+    if (expected.state == record.state && frameMatch) return true;
+    if (reader->diverged) return false;
+
+    reader->diverged = true;
+    reader->divergedTick = tick;
+    cout << "diverged at tick " << tick << ":";
+    for (size_t i = 0; i < STATE_FIELD_COUNT; i++){
+        if (expected.fields[i] != record.fields[i]) cout << " " << stateFieldNames[i];
+    }
+    if (!frameMatch) cout << " frame";
+    cout << endl;
+    return false;
+}
+
+//prints at most this many differences per array
+static const size_t diffLimit = 8;
+
+#define DIFF_VALUE(name, x, y) \
+    if ((x) != (y)){ \
+        fprintf(out, "  %s: %lld != %lld\n", name, (long long)(x), (long long)(y)); \
+        found++; \
+    }
+
+size_t gameDiff(const Game& a, const Game& b, FILE* out){
+    size_t found = 0;
+
+    DIFF_VALUE("tick", a.tick, b.tick);
+    DIFF_VALUE("score", a.score, b.score);
+    DIFF_VALUE("player.x", a.player.x, b.player.x);
+    DIFF_VALUE("player.lives", a.player.lives, b.player.lives);
+    DIFF_VALUE("player.alive", a.player.alive, b.player.alive);
+    DIFF_VALUE("rival.x", a.rival.x, b.rival.x);
+    DIFF_VALUE("rival.lives", a.rival.lives, b.rival.lives);
+    DIFF_VALUE("rival.alive", a.rival.alive, b.rival.alive);
+    DIFF_VALUE("rivalScore", a.rivalScore, b.rivalScore);
+    DIFF_VALUE("rng.state", a.rng.state, b.rng.state);
+
+    if (a.alienNum != b.alienNum){
+        DIFF_VALUE("alienNum", a.alienNum, b.alienNum);
+        return found;
+    }
+    size_t shown = 0;
+    for (size_t i = 0; i < a.alienNum && shown < diffLimit; i++){
+        const Alien& x = a.aliens[i];
+        const Alien& y = b.aliens[i];
+        if (x.x == y.x && x.y == y.y && x.type == y.type) continue;
+        fprintf(out, "  aliens[%zu]: (%zu, %zu) type %d != (%zu, %zu) type %d\n", i, x.x, x.y, x.type, y.x, y.y, y.type);
+        found++;
+        shown++;
+    }
+
+    const Formation& fa = a.formation;
+    const Formation& fb = b.formation;
+    DIFF_VALUE("formation.liveNum", fa.liveNum, fb.liveNum);
+    DIFF_VALUE("formation.offsetX", fa.offsetX, fb.offsetX);
+    DIFF_VALUE("formation.offsetY", fa.offsetY, fb.offsetY);
+    DIFF_VALUE("formation.moveX", fa.moveX, fb.moveX);
+    DIFF_VALUE("formation.moveY", fa.moveY, fb.moveY);
+    DIFF_VALUE("formation.cursor", fa.cursor, fb.cursor);
+    DIFF_VALUE("formation.invaded", fa.invaded, fb.invaded);
+
+    shown = 0;
+    for (size_t i = 0; i < a.animations.count && i < b.animations.count && shown < diffLimit; i++){
+        if (a.animations.frame[i] == b.animations.frame[i] && a.animations.counter[i] == b.animations.counter[i]) continue;
+        fprintf(out, "  animations[%zu]: frame %d counter %d != frame %d counter %d\n", i,
+            a.animations.frame[i], a.animations.counter[i], b.animations.frame[i], b.animations.counter[i]);
+        found++;
+        shown++;
+    }
+
+    DIFF_VALUE("bullets.count", a.bullets.count, b.bullets.count);
+    shown = 0;
+    for (size_t i = 0; i < a.bullets.count && i < b.bullets.count && shown < diffLimit; i++){
+        if (a.bullets.x[i] == b.bullets.x[i] && a.bullets.y[i] == b.bullets.y[i] && a.bullets.dir[i] == b.bullets.dir[i]) continue;
+        fprintf(out, "  bullets[%zu]: (%d, %d) dir %d != (%d, %d) dir %d\n", i,
+            a.bullets.x[i], a.bullets.y[i], a.bullets.dir[i], b.bullets.x[i], b.bullets.y[i], b.bullets.dir[i]);
+        found++;
+        shown++;
+    }
+
+    DIFF_VALUE("timers.now", a.timers.now, b.timers.now);
+    DIFF_VALUE("timers.activeNum", a.timers.activeNum, b.timers.activeNum);
+
+    for (size_t i = 0; i < SHIELD_COUNT; i++){
+        for (size_t j = 0; j < SHIELD_HEIGHT; j++){
+            if (a.shields[i].rows[j] == b.shields[i].rows[j]) continue;
+            fprintf(out, "  shields[%zu].rows[%zu]: %08x != %08x\n", i, j, a.shields[i].rows[j], b.shields[i].rows[j]);
+            found++;
+        }
+    }
+
+    if (a.botNum == b.botNum){
+        shown = 0;
+        for (size_t i = 0; i < a.botNum && shown < diffLimit; i++){
+            const Bot& x = a.bots[i];
+            const Bot& y = b.bots[i];
+            if (x.x == y.x && x.dir == y.dir && x.cooldown == y.cooldown) continue;
+            fprintf(out, "  bots[%zu]: x %d dir %d cooldown %u != x %d dir %d cooldown %u\n", i, x.x, x.dir, x.cooldown, y.x, y.dir, y.cooldown);
+            found++;
+            shown++;
+        }
+    }
+    else DIFF_VALUE("botNum", a.botNum, b.botNum);
+
+    return found;
+}
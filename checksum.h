@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdio>
+
+#include "game.h"
+#include "mapfile.h"
+
+#define CHECKSUM_MAGIC 0x53484953u //"SIHS"
+#define CHECKSUM_VERSION 2
+
+//slices of the canonical simulation state, each hashed on its own so that a
+//mismatch names the part of Game that diverged. capacities, handles and other
+//bookkeeping that doesn't change what happens next are left out.
+enum StateField{
+    STATE_SCALARS = 0, //tick, score, fire interval
+    STATE_PLAYER,
+    STATE_RNG,
+    STATE_ALIENS,
+    STATE_FORMATION,
+    STATE_ANIMATIONS,
+    STATE_BULLETS,
+    STATE_TIMERS,
+    STATE_SHIELDS,
+    STATE_BOTS,
+    STATE_FIELD_COUNT
+};
+
+extern const char* stateFieldNames[STATE_FIELD_COUNT];
+
+struct ChecksumRecord{
+    uint64_t state;
+    uint64_t buffer;
+    uint64_t fields[STATE_FIELD_COUNT];
+};
+
+//sidecar file next to a replay, one record per tick after the header
+struct ChecksumHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fieldNum;
+    uint32_t frames;
+    uint64_t tickNum;
+};
+
+struct ChecksumWriter{
+    FILE* file;
+    ChecksumHeader header;
+};
+
+struct ChecksumReader{
+    MappedFile file;
+    const ChecksumHeader* header;
+    const ChecksumRecord* records;
+    bool diverged;
+    uint64_t divergedTick;
+};
+
+//64 bit multiply-rotate hash, fast and well mixed but not cryptographic
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed);
+
+//hashes the state after a tick, and the frame drawn that tick if buffer is not null
+void checksumGame(const Game& game, const Buffer* buffer, ChecksumRecord* record);
+
+bool checksumCreate(ChecksumWriter* writer, const char* path, bool frames);
+void checksumWrite(ChecksumWriter* writer, const ChecksumRecord& record);
+bool checksumFinish(ChecksumWriter* writer);
+
+bool checksumOpen(ChecksumReader* reader, const char* path);
+void checksumClose(ChecksumReader* reader);
+
+//compares one tick with the recording. the first divergence is printed with the
+//fields that differ, later ticks only return false.
+bool checksumVerify(ChecksumReader* reader, uint64_t tick, const ChecksumRecord& record);
+
+//prints field by field differences between two games, returns the number found
+size_t gameDiff(const Game& a, const Game& b, FILE* out);
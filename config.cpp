@@ -0,0 +1,287 @@
+#include "config.h"
+#include "bullets.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+void configDefaults(GameConfig* config){
+    config->width = 224;
+    config->height = 256;
+    config->rows = 5;
+    config->cols = 11;
+    config->bulletCapacity = BULLET_POOL_CAPACITY;
+    config->botNum = 0;
+    config->fireInterval = 8;
+    config->seed = 0;
+    config->seedSet = false;
+    config->ticks = 0;
+    config->headless = false;
+    config->stats = false;
+    config->batchNum = 0;
+    config->threads = 0;
+    config->bridgeMode = BRIDGE_MODE_NONE;
+    config->bridgeName = "bench";
+    config->spin = 4096;
+    config->recordPath = nullptr;
+    config->playPath = nullptr;
+    config->verifyPath = nullptr;
+    config->savePath = nullptr;
+    config->loadPath = nullptr;
+    config->atlasPath = nullptr;
+    config->writeAtlasPath = nullptr;
+    config->rewindSeconds = 0;
+    config->versus = false;
+    config->netMode = NET_MODE_NONE;
+    config->netPort = 7000;
+    config->netDelay = 0;
+    config->netLoss = 0;
+    config->rollbackWindow = 8;
+    config->broadcastName = nullptr;
+    config->spectateName = nullptr;
+    config->eventsName = nullptr;
+    config->consumeName = nullptr;
+    config->tracePath = nullptr;
+    config->scenarioPath = nullptr;
+    config->updateBaseline = false;
+    config->tolerance = 20;
+    config->hashFrames = false;
+    config->check = false;
+}
+
+//load-test preset, anything given explicitly on the command line still wins
+static void configStress(GameConfig* config){
+    config->rows = 100;
+    config->cols = 100;
+    config->bulletCapacity = 4096;
+    config->botNum = 64;
+    config->fireInterval = 4;
+    config->ticks = 3600;
+    config->headless = true;
+    config->stats = true;
+}
+
+static void printUsage(){
+    cout << "usage: space-invaders [options]\n"
+            "  --stress          load-test preset (100x100 aliens, 64 bots, headless, stats)\n"
+            "  --rows N          formation rows\n"
+            "  --cols N          formation columns\n"
+            "  --bullets N       bullet capacity, raised to the most that can be in flight\n"
+            "  --bots N          autofire bots\n"
+            "  --fire-rate N     ticks between bot shots\n"
+            "  --width N         logical width, grown to fit the formation\n"
+            "  --height N        logical height, grown to fit the formation\n"
+            "  --seed N          rng seed, defaults to the clock\n"
+            "  --ticks N         stop after N ticks\n"
+            "  --headless        simulate and draw without a window\n"
+            "  --stats           print per-phase timings and recent frame histograms at exit\n"
+            "  --trace FILE      write the phases of the last frames as a Chrome trace at exit\n"
+            "  --batch N         step N games at once with random input and report steps/s\n"
+            "  --threads N       worker threads for --batch and --verify, defaults to all cores\n"
+            "  --host NAME       serve the game to an agent over shared memory NAME\n"
+            "  --agent NAME      drive a --host with random actions and report round trips/s,\n"
+            "                    frames are requested every tick unless --headless\n"
+            "  --bridge-bench    --host and --agent on two threads of this process\n"
+            "  --spin N          polls before a bridge wait sleeps, 0 always sleeps\n"
+            "  --record FILE     save the seed, config and input of this run as a replay\n"
+            "  --play FILE       re-simulate a replay, unthrottled with --headless, and compare it\n"
+            "                    with the per-tick checksums in FILE.sum if present\n"
+            "  --hash-frames     include the drawn frame in recorded checksums\n"
+            "  --verify DIR      re-simulate every replay in DIR on --threads workers and check\n"
+            "                    final scores and checksums\n"
+            "  --check           step two instances in lockstep and diff them at the first divergence\n"
+            "  --save FILE       write the whole game state to FILE at exit\n"
+            "  --load FILE       continue from a state saved with --save, its shape overrides the config\n"
+            "  --atlas FILE      draw with the sprites of an atlas file, reloaded when it changes\n"
+            "  --write-atlas FILE  write the built-in sprites as an atlas and exit\n"
+            "  --rewind N        keep N seconds of delta coded history, hold backspace to rewind,\n"
+            "                    headless runs report its size and check restores at exit\n"
+            "  --versus PORT     two player rollback game as player one on UDP PORT, the other\n"
+            "                    side joins with --versus-join PORT. both need the same --seed,\n"
+            "                    headless sides play randomly\n"
+            "  --versus-join PORT  two player rollback game as player two\n"
+            "  --versus-bench    both sides of a versus game on two threads of this process\n"
+            "  --net-delay MS    hold every outgoing versus packet back MS milliseconds\n"
+            "  --net-loss N      drop N percent of outgoing versus packets\n"
+            "  --rollback N      most ticks remote input is predicted ahead, 1 to 64\n"
+            "  --broadcast NAME  stream every drawn frame to spectators on local socket NAME\n"
+            "  --spectate NAME   watch a --broadcast game, headless only checks and counts frames\n"
+            "  --events NAME     publish kills, shots, hits and score changes to shared memory NAME\n"
+            "  --consume NAME    sample consumer, tallies the events of a running --events game\n"
+            "  --scenarios FILE  time the benchmark scenarios and fail if any is slower than the\n"
+            "                    baseline in FILE by more than --tolerance\n"
+            "  --update-baseline write the --scenarios timings to FILE instead of comparing\n"
+            "  --tolerance N     percent a scenario may be slower than its baseline, 20 by default\n";
+}
+
+static bool readNumber(int argc, char** argv, int* i, uint64_t* value){
+    if (*i + 1 >= argc){
+        cout << "Missing value for " << argv[*i] << endl;
+        return false;
+    }
+    char* end;
+    const char* text = argv[++*i];
+    *value = strtoull(text, &end, 10);
+    if (*text == '\0' || *end != '\0'){
+        cout << "Invalid value for " << argv[*i - 1] << ": " << text << endl;
+        return false;
+    }
+    return true;
+}
+
+bool configValidate(GameConfig* config){
+    if (!config->rows || !config->cols || config->rows * config->cols > CONFIG_MAX_ALIENS){
+        cout << "Formation must have between 1 and " << CONFIG_MAX_ALIENS << " aliens" << endl;
+        return false;
+    }
+    if (config->botNum > CONFIG_MAX_BOTS || config->bulletCapacity > CONFIG_MAX_BULLETS){
+        cout << "At most " << CONFIG_MAX_BOTS << " bots and " << CONFIG_MAX_BULLETS << " bullets" << endl;
+        return false;
+    }
+    if (!config->fireInterval) config->fireInterval = 1;
+
+    //grow the logical resolution until the formation, shields and HUD fit
+    size_t minWidth = 16 * config->cols + 40;
+    size_t minHeight = 17 * config->rows + 152;
+    if (config->width < minWidth) config->width = minWidth;
+    if (config->height < minHeight) config->height = minHeight;
+    //replay headers come from anywhere, an unbounded size would fail to allocate mid-run
+    if (config->width > CONFIG_MAX_SIZE || config->height > CONFIG_MAX_SIZE){
+        cout << "Resolution " << config->width << "x" << config->height << " is over the limit of " << CONFIG_MAX_SIZE << " a side" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool configParse(GameConfig* config, int argc, char** argv){
+    for (int i = 1; i < argc; i++){
+        if (!strcmp(argv[i], "--stress")) configStress(config);
+    }
+
+    for (int i = 1; i < argc; i++){
+        const char* arg = argv[i];
+        uint64_t value = 0;
+
+        if (!strcmp(arg, "--stress")) continue;
+        else if (!strcmp(arg, "--headless")) config->headless = true;
+        else if (!strcmp(arg, "--stats")) config->stats = true;
+        else if (!strcmp(arg, "--hash-frames")) config->hashFrames = true;
+        else if (!strcmp(arg, "--check")) config->check = true;
+        else if (!strcmp(arg, "--update-baseline")) config->updateBaseline = true;
+        else if (!strcmp(arg, "--bridge-bench")) config->bridgeMode = BRIDGE_MODE_BENCH;
+        else if (!strcmp(arg, "--versus-bench")) config->netMode = NET_MODE_BENCH;
+        else if (!strcmp(arg, "--host") || !strcmp(arg, "--agent") || !strcmp(arg, "--record") || !strcmp(arg, "--play") || !strcmp(arg, "--verify") ||
+                 !strcmp(arg, "--save") || !strcmp(arg, "--load") || !strcmp(arg, "--atlas") || !strcmp(arg, "--write-atlas") || !strcmp(arg, "--broadcast") || !strcmp(arg, "--spectate") ||
+                 !strcmp(arg, "--events") || !strcmp(arg, "--consume") || !strcmp(arg, "--scenarios") || !strcmp(arg, "--trace")){
+            if (i + 1 >= argc){
+                cout << "Missing value for " << arg << endl;
+                return false;
+            }
+            const char* text = argv[++i];
+
+            if (!strcmp(arg, "--record")) config->recordPath = text;
+            else if (!strcmp(arg, "--play")) config->playPath = text;
+            else if (!strcmp(arg, "--verify")) config->verifyPath = text;
+            else if (!strcmp(arg, "--save")) config->savePath = text;
+            else if (!strcmp(arg, "--load")) config->loadPath = text;
+            else if (!strcmp(arg, "--atlas")) config->atlasPath = text;
+            else if (!strcmp(arg, "--write-atlas")) config->writeAtlasPath = text;
+            else if (!strcmp(arg, "--broadcast")) config->broadcastName = text;
+            else if (!strcmp(arg, "--spectate")) config->spectateName = text;
+            else if (!strcmp(arg, "--events")) config->eventsName = text;
+            else if (!strcmp(arg, "--consume")) config->consumeName = text;
+            else if (!strcmp(arg, "--scenarios")) config->scenarioPath = text;
+            else if (!strcmp(arg, "--trace")) config->tracePath = text;
+            else {
+                config->bridgeMode = !strcmp(arg, "--host") ? BRIDGE_MODE_HOST : BRIDGE_MODE_AGENT;
+                config->bridgeName = text;
+            }
+        }
+        else if (!strcmp(arg, "--help")){
+            printUsage();
+            return false;
+        }
+        else if (!strcmp(arg, "--rows") || !strcmp(arg, "--cols") || !strcmp(arg, "--bullets") || !strcmp(arg, "--bots") || !strcmp(arg, "--fire-rate") ||
+                 !strcmp(arg, "--width") || !strcmp(arg, "--height") || !strcmp(arg, "--seed") || !strcmp(arg, "--ticks") ||
+                 !strcmp(arg, "--batch") || !strcmp(arg, "--threads") || !strcmp(arg, "--spin") || !strcmp(arg, "--rewind") ||
+                 !strcmp(arg, "--versus") || !strcmp(arg, "--versus-join") || !strcmp(arg, "--net-delay") || !strcmp(arg, "--net-loss") ||
+                 !strcmp(arg, "--rollback") || !strcmp(arg, "--tolerance")){
+            if (!readNumber(argc, argv, &i, &value)) return false;
+
+            if (!strcmp(arg, "--rows")) config->rows = (size_t)value;
+            else if (!strcmp(arg, "--cols")) config->cols = (size_t)value;
+            else if (!strcmp(arg, "--bullets")) config->bulletCapacity = (size_t)value;
+            else if (!strcmp(arg, "--bots")) config->botNum = (size_t)value;
+            else if (!strcmp(arg, "--fire-rate")) config->fireInterval = (uint32_t)value;
+            else if (!strcmp(arg, "--width")) config->width = (size_t)value;
+            else if (!strcmp(arg, "--height")) config->height = (size_t)value;
+            else if (!strcmp(arg, "--seed")){
+                config->seed = value;
+                config->seedSet = true;
+            }
+            else if (!strcmp(arg, "--batch")) config->batchNum = (size_t)value;
+            else if (!strcmp(arg, "--threads")) config->threads = (size_t)value;
+            else if (!strcmp(arg, "--spin")) config->spin = (uint32_t)value;
+            else if (!strcmp(arg, "--rewind")) config->rewindSeconds = (size_t)value;
+            else if (!strcmp(arg, "--versus") || !strcmp(arg, "--versus-join")){
+                if (!value || value > 65534){
+                    cout << "Invalid port " << value << endl;
+                    return false;
+                }
+                config->netMode = !strcmp(arg, "--versus") ? NET_MODE_HOST : NET_MODE_JOIN;
+                config->netPort = (uint16_t)value;
+            }
+            else if (!strcmp(arg, "--net-delay")) config->netDelay = (uint32_t)value;
+            else if (!strcmp(arg, "--net-loss")) config->netLoss = (uint32_t)value;
+            else if (!strcmp(arg, "--rollback")) config->rollbackWindow = (size_t)value;
+            else if (!strcmp(arg, "--tolerance")) config->tolerance = (uint32_t)value;
+            else config->ticks = (size_t)value;
+        }
+        else {
+            cout << "Unknown option " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    if (!configValidate(config)) return false;
+
+    //replays and lockstep checks start from a seed, not from a saved state
+    if (config->loadPath && (config->playPath || config->recordPath || config->check)){
+        cout << "--load can't be combined with --play, --record or --check" << endl;
+        return false;
+    }
+    //versus games have two input streams where replays and rewinds hold one, and both sides
+    //have to start from the same seed rather than a loaded state
+    config->versus = config->netMode != NET_MODE_NONE;
+    if (config->versus && (config->recordPath || config->playPath || config->check || config->rewindSeconds || config->loadPath ||
+                           config->batchNum || config->bridgeMode != BRIDGE_MODE_NONE || config->verifyPath)){
+        cout << "versus games can't be combined with replays, checks, --rewind, --load, batches or bridges" << endl;
+        return false;
+    }
+    //the two sides of a networked game are separate processes, each would pick its own clock seed
+    if ((config->netMode == NET_MODE_HOST || config->netMode == NET_MODE_JOIN) && !config->seedSet){
+        cout << "--versus and --versus-join need the same --seed on both sides" << endl;
+        return false;
+    }
+    if (config->netLoss >= 100){
+        cout << "--net-loss must be below 100" << endl;
+        return false;
+    }
+
+    //a rewound run no longer matches its input stream
+    if (config->rewindSeconds && (config->recordPath || config->check)){
+        cout << "--rewind can't be combined with --record or --check" << endl;
+        return false;
+    }
+
+    if (!config->seedSet){
+        config->seed = (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define CONFIG_MAX_ALIENS 100000
+//largest logical width or height, a 256 MB frame. 316x316 aliens still fit
+#define CONFIG_MAX_SIZE 8192
+#define CONFIG_MAX_BOTS 4096
+#define CONFIG_MAX_BULLETS (1 << 20)
+
+enum BridgeMode : uint8_t{
+    BRIDGE_MODE_NONE = 0,
+    BRIDGE_MODE_HOST = 1,
+    BRIDGE_MODE_AGENT = 2,
+    BRIDGE_MODE_BENCH = 3
+};
+
+enum NetMode : uint8_t{
+    NET_MODE_NONE = 0,
+    NET_MODE_HOST = 1,
+    NET_MODE_JOIN = 2,
+    NET_MODE_BENCH = 3
+};
+
+struct GameConfig{
+    size_t width, height;
+    size_t rows, cols;
+    size_t bulletCapacity;
+    size_t botNum;
+    uint32_t fireInterval;
+    uint64_t seed;
+    bool seedSet;
+    size_t ticks;
+    bool headless;
+    bool stats;
+    size_t batchNum;
+    size_t threads;
+    BridgeMode bridgeMode;
+    const char* bridgeName;
+    uint32_t spin;
+    const char* recordPath;
+    const char* playPath;
+    const char* verifyPath;
+    const char* savePath;
+    const char* loadPath;
+    const char* atlasPath;
+    const char* writeAtlasPath;
+    size_t rewindSeconds;
+    bool versus;
+    NetMode netMode;
+    uint16_t netPort;
+    uint32_t netDelay;
+    uint32_t netLoss;
+    size_t rollbackWindow;
+    const char* broadcastName;
+    const char* spectateName;
+    const char* eventsName;
+    const char* consumeName;
+    const char* tracePath;
+    const char* scenarioPath;
+    bool updateBaseline;
+    uint32_t tolerance;
+    bool hashFrames;
+    bool check;
+};
+
+void configDefaults(GameConfig* config);
+
+//checks the formation size and grows the resolution to fit it, prints and returns false on bad
+//input or anything over the CONFIG_MAX limits
+bool configValidate(GameConfig* config);
+
+//reads command line options over the defaults, prints usage and returns false on bad input
+bool configParse(GameConfig* config, int argc, char** argv);
@@ -0,0 +1,162 @@
+#include "env.h"
+#include "game.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+struct Env{
+    Assets assets;
+    Game* game;
+    Buffer buffer;
+    bool render;
+    size_t scale;
+    size_t grayWidth, grayHeight;
+    size_t stackNum, stackHead;
+    uint8_t* stack;
+    size_t lastScore;
+    int32_t reward;
+};
+
+//box filters scale x scale blocks of the frame into one luma byte each
+static void envDownsample(const Env* env, uint8_t* gray){
+    const Buffer& buffer = env->buffer;
+    size_t scale = env->scale;
+    uint32_t area = (uint32_t)(scale * scale);
+
+    for (size_t gy = 0; gy < env->grayHeight; gy++){
+        for (size_t gx = 0; gx < env->grayWidth; gx++){
+            uint32_t sum = 0;
+            for (size_t dy = 0; dy < scale; dy++){
+                const uint32_t* pixel = buffer.data + (gy * scale + dy) * buffer.width + gx * scale;
+                for (size_t dx = 0; dx < scale; dx++){
+                    uint32_t p = pixel[dx];
+                    sum += (77 * (p >> 24) + 150 * ((p >> 16) & 255) + 29 * ((p >> 8) & 255)) >> 8;
+                }
+            }
+            gray[gy * env->grayWidth + gx] = (uint8_t)(sum / area);
+        }
+    }
+}
+
+static void envObserve(Env* env, bool first){
+    if (!env->render) return;
+    gameDraw(&env->buffer, *env->game, env->assets);
+
+    if (!env->scale) return;
+    size_t frameSize = env->grayWidth * env->grayHeight;
+    env->stackHead = first ? 0 : (env->stackHead + 1) % env->stackNum;
+    uint8_t* gray = env->stack + env->stackHead * frameSize;
+    envDownsample(env, gray);
+
+    if (first){
+        for (size_t i = 1; i < env->stackNum; i++){
+            memcpy(env->stack + i * frameSize, gray, frameSize);
+        }
+    }
+}
+
+Env* envCreate(const EnvOptions* options){
+    GameConfig config;
+    configDefaults(&config);
+    if (options->rows) config.rows = options->rows;
+    if (options->cols) config.cols = options->cols;
+    if (options->width) config.width = options->width;
+    if (options->height) config.height = options->height;
+    if (!configValidate(&config)) return nullptr;
+
+    if (options->downsample > config.width || options->downsample > config.height){
+        cout << "Downsample factor " << options->downsample << " is larger than the frame" << endl;
+        return nullptr;
+    }
+
+    Env* env = new Env;
+    assetsInit(&env->assets);
+    env->game = gameCreate(config, env->assets);
+
+    env->scale = options->downsample;
+    env->render = options->render || env->scale;
+    env->buffer.width = config.width;
+    env->buffer.height = config.height;
+    env->buffer.data = env->render ? new uint32_t[config.width * config.height] : nullptr;
+
+    env->grayWidth = env->scale ? config.width / env->scale : 0;
+    env->grayHeight = env->scale ? config.height / env->scale : 0;
+    env->stackNum = env->scale ? (options->stack ? options->stack : 1) : 0;
+    env->stackHead = 0;
+    env->stack = env->scale ? new uint8_t[env->stackNum * env->grayWidth * env->grayHeight] : nullptr;
+
+    envReset(env, config.seed);
+    return env;
+}
+
+void envDestroy(Env* env){
+    if (!env) return;
+    delete[] env->buffer.data;
+    delete[] env->stack;
+    gameDestroy(env->game);
+    assetsFree(&env->assets);
+    delete env;
+}
+
+void envReset(Env* env, uint64_t seed){
+    gameReset(env->game, env->assets, seed);
+    env->lastScore = 0;
+    env->reward = 0;
+    envObserve(env, true);
+}
+
+int32_t envStep(Env* env, uint32_t action){
+    gameStep(env->game, env->assets, gameInputUnpack(action));
+
+    env->reward = (int32_t)(env->game->score - env->lastScore);
+    env->lastScore = env->game->score;
+    envObserve(env, false);
+    return env->reward;
+}
+
+int32_t envReward(const Env* env){
+    return env->reward;
+}
+
+int32_t envDone(const Env* env){
+    return gameOver(*env->game);
+}
+
+uint32_t envLives(const Env* env){
+    return (uint32_t)env->game->player.lives;
+}
+
+const uint32_t* envFrame(const Env* env, size_t* width, size_t* height){
+    *width = env->buffer.width;
+    *height = env->buffer.height;
+    return env->buffer.data;
+}
+
+const uint8_t* envGray(const Env* env, size_t* width, size_t* height){
+    *width = env->grayWidth;
+    *height = env->grayHeight;
+    if (!env->stack) return nullptr;
+    return env->stack + env->stackHead * env->grayWidth * env->grayHeight;
+}
+
+const uint8_t* envStack(const Env* env, size_t* frameNum, size_t* newest){
+    *frameNum = env->stackNum;
+    *newest = env->stackHead;
+    return env->stack;
+}
+
+void envFeatures(const Env* env, EnvFeatures* features){
+    const Game& game = *env->game;
+    features->playerX = (int32_t)game.player.x;
+    features->playerAlive = game.player.alive;
+    features->lives = (uint32_t)game.player.lives;
+    features->liveNum = (uint32_t)game.formation.liveNum;
+    features->alienNum = game.alienNum;
+    features->alive = game.formation.aliveBits;
+    features->bulletNum = game.bullets.count;
+    features->bulletX = game.bullets.x;
+    features->bulletY = game.bullets.y;
+    features->bulletDir = game.bullets.dir;
+}
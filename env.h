@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//embedding API for agents and scripts, plain C so it can sit behind an FFI.
+//all memory is allocated by envCreate, stepping and observing never allocate or
+//copy: observations are read-only views into the simulation and the frame stack
+//is a ring the downsampler writes straight into.
+
+//the space-invaders-env library defines ENV_BUILD and exports these, code using the
+//DLL on Windows defines ENV_DLL to import them. linked in directly, neither is needed
+#if defined(_WIN32) && defined(ENV_BUILD)
+#define ENV_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(ENV_DLL)
+#define ENV_API __declspec(dllimport)
+#elif defined(ENV_BUILD)
+#define ENV_API __attribute__((visibility("default")))
+#else
+#define ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Env Env;
+
+enum EnvAction{
+    ENV_NOOP = 0,
+    ENV_LEFT = 1,
+    ENV_RIGHT = 2,
+    ENV_FIRE = 4
+};
+
+//zero fields take the game defaults
+typedef struct EnvOptions{
+    uint32_t rows, cols;
+    uint32_t width, height;
+    uint32_t render;     //draw the full frame every step
+    uint32_t downsample; //grayscale frame at 1/n resolution, 0 for none, implies render
+    uint32_t stack;      //grayscale frames kept in the ring, at least 1 when downsampling
+} EnvOptions;
+
+//compact state, every pointer aliases simulation memory and is valid until the next step
+typedef struct EnvFeatures{
+    int32_t playerX;
+    int32_t playerAlive;
+    uint32_t lives;
+    uint32_t liveNum;
+    size_t alienNum;
+    const uint64_t* alive; //bit i set while alien i is alive, (alienNum + 63) / 64 words
+    size_t bulletNum;
+    const int32_t* bulletX;
+    const int32_t* bulletY;
+    const int32_t* bulletDir; //positive for player shots
+} EnvFeatures;
+
+//returns NULL if the options are invalid
+ENV_API Env* envCreate(const EnvOptions* options);
+ENV_API void envDestroy(Env* env);
+
+ENV_API void envReset(Env* env, uint64_t seed);
+
+//applies an EnvAction mask for one tick and returns the reward, the score gained this tick
+ENV_API int32_t envStep(Env* env, uint32_t action);
+
+ENV_API int32_t envReward(const Env* env);
+ENV_API int32_t envDone(const Env* env);
+ENV_API uint32_t envLives(const Env* env);
+
+//RGBA frame, row 0 is the bottom row. NULL unless rendering
+ENV_API const uint32_t* envFrame(const Env* env, size_t* width, size_t* height);
+
+//newest grayscale frame, NULL unless downsampling
+ENV_API const uint8_t* envGray(const Env* env, size_t* width, size_t* height);
+
+//the whole ring of frameNum grayscale frames, frame newest is the latest and
+//(newest - k) mod frameNum is k steps older. after a reset every slot holds the first frame.
+ENV_API const uint8_t* envStack(const Env* env, size_t* frameNum, size_t* newest);
+
+ENV_API void envFeatures(const Env* env, EnvFeatures* features);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+//smallest agent of the env library: plays random episodes through the C API only and
+//checks what an embedder relies on, the frame stack ring and the feature views
+#include "env.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static uint64_t rngState = 0x9E3779B97F4A7C15ull;
+
+static uint32_t randomAction(){
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (uint32_t)(rngState & (ENV_LEFT | ENV_RIGHT | ENV_FIRE));
+}
+
+int main(int argc, char** argv){
+    size_t episodes = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 3;
+
+    EnvOptions options;
+    memset(&options, 0, sizeof(options));
+    options.downsample = 4;
+    options.stack = 4;
+    Env* env = envCreate(&options);
+    if (!env){
+        printf("envCreate failed\n");
+        return -1;
+    }
+
+    bool ok = true;
+    for (size_t episode = 0; episode < episodes; episode++){
+        envReset(env, episode + 1);
+
+        size_t grayWidth, grayHeight, frameNum, newest;
+        envGray(env, &grayWidth, &grayHeight);
+        const uint8_t* stack = envStack(env, &frameNum, &newest);
+        size_t frameSize = grayWidth * grayHeight;
+
+        //after a reset every slot of the ring holds the first frame
+        for (size_t i = 1; i < frameNum; i++){
+            if (memcmp(stack, stack + i * frameSize, frameSize)) ok = false;
+        }
+
+        long long total = 0;
+        size_t steps = 0;
+        while (!envDone(env) && steps < 20000){
+            total += envStep(env, randomAction());
+            steps++;
+
+            //the newest slot advances one frame per step and is what envGray returns
+            size_t head;
+            envStack(env, &frameNum, &head);
+            if (head != (newest + 1) % frameNum || envGray(env, &grayWidth, &grayHeight) != stack + head * frameSize) ok = false;
+            newest = head;
+        }
+
+        EnvFeatures features;
+        envFeatures(env, &features);
+        printf("episode %zu: %zu steps, reward %lld, %u of %zu aliens left, %u lives, %zu bullets, %zux%zu gray x %zu\n", episode, steps, total,
+            features.liveNum, features.alienNum, envLives(env), features.bulletNum, grayWidth, grayHeight, frameNum);
+    }
+
+    envDestroy(env);
+    printf(ok ? "frame stack consistent\n" : "frame stack inconsistent\n");
+    return ok ? 0 : -1;
+}
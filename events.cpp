@@ -0,0 +1,119 @@
+#include "events.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static_assert(sizeof(GameEvent) == 32, "event records are part of the shared layout");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the ring needs lock-free atomics in shared memory");
+
+const char* eventTypeNames[EVENT_TYPE_COUNT] = {
+    "shot",
+    "alien killed",
+    "score",
+    "player hit",
+    "player respawn",
+    "invaded"
+};
+
+static thread_local EventRing* attached = nullptr;
+static thread_local vector<GameEvent>* staged = nullptr;
+
+static size_t recordsOffset(){
+    return (sizeof(EventRingHeader) + 63) & ~(size_t)63;
+}
+
+bool eventsCreate(EventRing* ring, const char* name, size_t capacity){
+    memset(ring, 0, sizeof(EventRing));
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    if (!sharedCreate(&ring->shared, name, recordsOffset() + size * sizeof(GameEvent))) return false;
+
+    memset(ring->shared.memory, 0, ring->shared.size);
+    ring->header = (EventRingHeader*)ring->shared.memory;
+    ring->records = (GameEvent*)(ring->shared.memory + recordsOffset());
+    ring->mask = size - 1;
+
+    EventRingHeader* header = ring->header;
+    header->version = EVENT_VERSION;
+    header->capacity = size;
+    atomic_thread_fence(memory_order_release);
+    header->magic = EVENT_MAGIC;
+    return true;
+}
+
+bool eventsOpen(EventRing* ring, const char* name){
+    memset(ring, 0, sizeof(EventRing));
+    if (!sharedOpen(&ring->shared, name, recordsOffset())) return false;
+
+    EventRingHeader* header = (EventRingHeader*)ring->shared.memory;
+    if (header->magic != EVENT_MAGIC || header->version != EVENT_VERSION ||
+        recordsOffset() + header->capacity * sizeof(GameEvent) > ring->shared.size){
+        cout << "Shared memory " << ring->shared.name << " is not a version " << EVENT_VERSION << " event ring" << endl;
+        sharedClose(&ring->shared);
+        return false;
+    }
+    ring->header = header;
+    ring->records = (GameEvent*)(ring->shared.memory + recordsOffset());
+    ring->mask = header->capacity - 1;
+    return true;
+}
+
+void eventsClose(EventRing* ring){
+    if (ring->shared.owner) ring->header->closed.store(1, memory_order_release);
+    if (attached == ring) attached = nullptr;
+    sharedClose(&ring->shared);
+    memset(ring, 0, sizeof(EventRing));
+}
+
+bool eventPush(EventRing* ring, const GameEvent& event){
+    EventRingHeader* header = ring->header;
+    uint64_t head = ring->head;
+    if (head - ring->tailCache > ring->mask){
+        ring->tailCache = header->tail.load(memory_order_acquire);
+        if (head - ring->tailCache > ring->mask){
+            header->dropped.fetch_add(1, memory_order_relaxed);
+            header->droppedByType[event.type].fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+    }
+
+    ring->records[head & ring->mask] = event;
+    ring->head = head + 1;
+    header->head.store(head + 1, memory_order_release);
+
+    uint64_t used = head + 1 - ring->tailCache;
+    if (used > ring->highWater) ring->highWater = used;
+    return true;
+}
+
+size_t eventsPoll(EventRing* ring, GameEvent* out, size_t max){
+    EventRingHeader* header = ring->header;
+    uint64_t tail = header->tail.load(memory_order_relaxed);
+    uint64_t head = header->head.load(memory_order_acquire);
+
+    size_t count = 0;
+    while (tail != head && count < max){
+        out[count++] = ring->records[tail & ring->mask];
+        tail++;
+    }
+    header->tail.store(tail, memory_order_release);
+    return count;
+}
+
+void eventsAttach(EventRing* ring){
+    attached = ring;
+}
+
+EventRing* eventsAttached(){
+    return attached;
+}
+
+void eventsStage(vector<GameEvent>* stage){
+    staged = stage;
+}
+
+vector<GameEvent>* eventsStaged(){
+    return staged;
+}
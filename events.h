@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "shm.h"
+
+#define EVENT_MAGIC 0x56454953u //"SIEV"
+#define EVENT_VERSION 1
+#define EVENT_RING_CAPACITY 65536 //records, a power of two
+
+enum EventType : uint16_t{
+    EVENT_SHOT = 0,       //x, y where the shot starts, value is its direction
+    EVENT_ALIEN_KILLED,   //x, y of the alien, value is its index, extra its type
+    EVENT_SCORE,          //value is the points gained, extra the shooter's new total
+    EVENT_PLAYER_HIT,     //x, y of the player, value is the lives left
+    EVENT_PLAYER_RESPAWN,
+    EVENT_INVADED,        //the formation reached the floor and ended the game
+    EVENT_TYPE_COUNT
+};
+
+//who an event is about
+enum EventSource : uint8_t{
+    EVENT_BY_PLAYER = 0,
+    EVENT_BY_RIVAL = 1,
+    EVENT_BY_ALIENS = 2,
+    EVENT_BY_BOT = 3
+};
+
+extern const char* eventTypeNames[EVENT_TYPE_COUNT];
+
+//fixed size so the ring is a plain array and records never straddle a wrap
+struct GameEvent{
+    uint64_t tick;
+    uint16_t type;
+    uint8_t source;
+    uint8_t reserved;
+    int32_t x, y;
+    uint32_t value;
+    uint32_t extra;
+    uint32_t padding;
+};
+
+//single producer, single consumer ring at the start of the shared region, records
+//follow it. head and tail sit on their own cache lines so the two sides only share
+//a line when one of them actually reads the other's index. the producer never
+//waits: when the ring is full the event is dropped and counted.
+struct EventRingHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+
+    alignas(64) std::atomic<uint64_t> head;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> droppedByType[EVENT_TYPE_COUNT];
+    std::atomic<uint32_t> closed;
+
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+struct EventRing{
+    SharedMemory shared;
+    EventRingHeader* header;
+    GameEvent* records;
+    uint64_t mask;
+    uint64_t head;      //producer's own copy of header->head
+    uint64_t tailCache; //producer's last look at header->tail, refreshed only when the ring seems full
+    uint64_t highWater;
+};
+
+//producer side, creates the region NAME
+bool eventsCreate(EventRing* ring, const char* name, size_t capacity);
+
+//consumer side, maps a region created by a running producer
+bool eventsOpen(EventRing* ring, const char* name);
+
+//a closing producer marks the ring so consumers can drain it and stop
+void eventsClose(EventRing* ring);
+
+//false if the ring was full and the event was dropped
+bool eventPush(EventRing* ring, const GameEvent& event);
+
+//copies up to max waiting events into out and frees their slots
+size_t eventsPoll(EventRing* ring, GameEvent* out, size_t max);
+
+//the simulation emits into the ring attached to the calling thread, if any. a
+//thread re-simulating ticks it has already emitted detaches while it does so
+void eventsAttach(EventRing* ring);
+EventRing* eventsAttached();
+
+//while a stage is set on the calling thread the simulation appends to it instead of the
+//ring. a thread running ticks that may still be re-simulated stages their events and
+//publishes them once the ticks are final
+void eventsStage(std::vector<GameEvent>* stage);
+std::vector<GameEvent>* eventsStaged();
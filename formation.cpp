@@ -0,0 +1,164 @@
+#include "formation.h"
+
+#include <cstring>
+
+void formationInit(Formation* formation, Arena* arena, size_t rows, size_t cols){
+    memset(formation, 0, sizeof(Formation));
+    formation->rows = rows;
+    formation->cols = cols;
+    formation->alive = arenaAlloc<uint8_t>(arena, rows * cols);
+    formation->aliveBits = arenaAlloc<uint64_t>(arena, (rows * cols + 63) / 64);
+    formation->colLive = arenaAlloc<uint32_t>(arena, cols);
+    formation->rowLive = arenaAlloc<uint32_t>(arena, rows);
+    formation->next = arenaAlloc<uint32_t>(arena, rows * cols);
+    formation->prev = arenaAlloc<uint32_t>(arena, rows * cols);
+    formation->colBottom = arenaAlloc<uint32_t>(arena, cols);
+    formation->liveCols = arenaAlloc<uint32_t>(arena, cols);
+    formation->colSlot = arenaAlloc<uint32_t>(arena, cols);
+    formation->stepX = 2;
+    formation->stepY = 8;
+    if (arenaMeasuring(*arena)) return;
+    formationReset(formation);
+}
+
+//puts every alien back alive and at the start of the march, geometry is left alone
+void formationReset(Formation* formation){
+    size_t alienNum = formation->rows * formation->cols;
+
+    formation->liveNum = alienNum;
+    for (size_t i = 0; i < formation->cols; i++){
+        formation->colLive[i] = (uint32_t)formation->rows;
+        formation->colBottom[i] = 0;
+        formation->liveCols[i] = (uint32_t)i;
+        formation->colSlot[i] = (uint32_t)i;
+    }
+    formation->liveColNum = formation->rows ? formation->cols : 0;
+    for (size_t i = 0; i < formation->rows; i++){
+        formation->rowLive[i] = (uint32_t)formation->cols;
+    }
+    for (size_t i = 0; i < alienNum; i++){
+        formation->alive[i] = 1;
+        formation->next[i] = i + 1 < alienNum ? (uint32_t)(i + 1) : FORMATION_NONE;
+        formation->prev[i] = i > 0 ? (uint32_t)(i - 1) : FORMATION_NONE;
+    }
+    for (size_t i = 0; i < alienNum / 64; i++){
+        formation->aliveBits[i] = ~0ull;
+    }
+    if (alienNum % 64) formation->aliveBits[alienNum / 64] = (1ull << (alienNum % 64)) - 1;
+
+    formation->left = 0;
+    formation->right = formation->cols ? formation->cols - 1 : 0;
+    formation->bottom = 0;
+    formation->head = alienNum ? 0 : FORMATION_NONE;
+    formation->cursor = formation->head;
+    formation->offsetX = 0;
+    formation->offsetY = 0;
+    if (formation->stepX < 0) formation->stepX = -formation->stepX;
+    formation->moveX = formation->stepX;
+    formation->moveY = 0;
+    formation->invaded = false;
+}
+
+void formationKill(Formation* formation, uint32_t alien){
+    size_t row = alien / formation->cols;
+    size_t col = alien % formation->cols;
+
+    uint32_t prev = formation->prev[alien];
+    uint32_t next = formation->next[alien];
+    if (prev != FORMATION_NONE) formation->next[prev] = next;
+    else formation->head = next;
+    if (next != FORMATION_NONE) formation->prev[next] = prev;
+    if (formation->cursor == alien) formation->cursor = next;
+
+    formation->alive[alien] = 0;
+    formation->aliveBits[alien / 64] &= ~(1ull << (alien % 64));
+    formation->liveNum--;
+    formation->colLive[col]--;
+    formation->rowLive[row]--;
+
+    if (!formation->colLive[col]){
+        uint32_t slot = formation->colSlot[col];
+        uint32_t last = formation->liveCols[--formation->liveColNum];
+        formation->liveCols[slot] = last;
+        formation->colSlot[last] = slot;
+    }
+    else if (formation->colBottom[col] == row){
+        size_t bottom = row + 1;
+        while (!formation->alive[bottom * formation->cols + col]) bottom++;
+        formation->colBottom[col] = (uint32_t)bottom;
+    }
+
+    if (!formation->liveNum) return;
+
+    while (!formation->colLive[formation->left]) formation->left++;
+    while (!formation->colLive[formation->right]) formation->right--;
+    while (!formation->rowLive[formation->bottom]) formation->bottom++;
+}
+
+static int32_t floorDiv(int32_t a, int32_t b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+bool formationCells(const Formation& formation, int32_t x, int32_t y, int32_t w, int32_t h, size_t* col0, size_t* col1, size_t* row0, size_t* row1){
+    int32_t stepX = formation.stepX < 0 ? -formation.stepX : formation.stepX;
+    int32_t fx = x - formation.originX - formation.offsetX;
+    int32_t fy = y - formation.originY - formation.offsetY;
+
+    int32_t c0 = floorDiv(fx - formation.cellWidth - stepX, formation.colSpacing);
+    int32_t c1 = floorDiv(fx + w + stepX, formation.colSpacing);
+    int32_t r0 = floorDiv(fy - formation.cellHeight, formation.rowSpacing);
+    int32_t r1 = floorDiv(fy + h + formation.stepY, formation.rowSpacing);
+
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= (int32_t)formation.cols) c1 = (int32_t)formation.cols - 1;
+    if (r1 >= (int32_t)formation.rows) r1 = (int32_t)formation.rows - 1;
+    if (c0 > c1 || r0 > r1) return false;
+
+    *col0 = (size_t)c0;
+    *col1 = (size_t)c1;
+    *row0 = (size_t)r0;
+    *row1 = (size_t)r1;
+    return true;
+}
+
+//a sweep has just finished, fold its move into the offset and choose the next one
+static void formationEndSweep(Formation* formation){
+    formation->offsetX += formation->moveX;
+    formation->offsetY += formation->moveY;
+
+    int32_t left = formation->originX + formation->offsetX + (int32_t)formation->left * formation->colSpacing;
+    int32_t right = formation->originX + formation->offsetX + (int32_t)formation->right * formation->colSpacing + formation->cellWidth;
+    int32_t bottom = formation->originY + formation->offsetY + (int32_t)formation->bottom * formation->rowSpacing;
+
+    if (bottom <= formation->floorY){
+        formation->invaded = true;
+        return;
+    }
+
+    if (formation->moveY){
+        formation->moveX = formation->stepX;
+        formation->moveY = 0;
+    }
+    else if (left + formation->stepX < formation->minX || right + formation->stepX > formation->maxX){
+        formation->stepX = -formation->stepX;
+        formation->moveX = 0;
+        formation->moveY = -formation->stepY;
+    }
+}
+
+bool formationStep(Formation* formation, uint32_t* alien, int32_t* dx, int32_t* dy){
+    if (!formation->liveNum || formation->invaded) return false;
+
+    if (formation->cursor == FORMATION_NONE){
+        formationEndSweep(formation);
+        if (formation->invaded) return false;
+        formation->cursor = formation->head;
+    }
+
+    *alien = formation->cursor;
+    *dx = formation->moveX;
+    *dy = formation->moveY;
+    formation->cursor = formation->next[formation->cursor];
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "arena.h"
+
+#define FORMATION_NONE 0xFFFFFFFFu
+
+//arcade march: one live alien steps per tick, so a full sweep takes as many ticks
+//as there are aliens left and the formation speeds up as it thins out.
+//extents are kept as live counts per row and column, which only ever shrink
+//inwards, so kills keep them current in amortised O(1) without rescanning aliens.
+//the same goes for the lowest live row of each column, which only moves up.
+struct Formation{
+    size_t rows, cols;
+    size_t liveNum;
+    RelPtr<uint8_t> alive;
+    RelPtr<uint64_t> aliveBits; //alive packed 64 aliens to a word
+    RelPtr<uint32_t> colLive;
+    RelPtr<uint32_t> rowLive;
+    size_t left, right, bottom;
+
+    //bottom live row per column and a dense list of columns that still have aliens
+    RelPtr<uint32_t> colBottom;
+    RelPtr<uint32_t> liveCols;
+    RelPtr<uint32_t> colSlot;
+    size_t liveColNum;
+
+    //live aliens in march order, alien index = row * cols + col
+    RelPtr<uint32_t> next;
+    RelPtr<uint32_t> prev;
+    uint32_t head;
+    uint32_t cursor;
+
+    //grid geometry, column 0 / row 0 is the bottom left cell
+    int32_t originX, originY;
+    int32_t colSpacing, rowSpacing;
+    int32_t cellWidth, cellHeight;
+    int32_t minX, maxX, floorY;
+
+    //offset of aliens that have finished the current sweep
+    int32_t offsetX, offsetY;
+    int32_t stepX, stepY;
+    int32_t moveX, moveY;
+    bool invaded;
+};
+
+void formationInit(Formation* formation, Arena* arena, size_t rows, size_t cols);
+void formationReset(Formation* formation);
+
+void formationKill(Formation* formation, uint32_t alien);
+
+//lowest live alien of the n-th live column, n < liveColNum
+inline uint32_t formationShooter(const Formation& formation, size_t n){
+    uint32_t col = formation.liveCols[n];
+    return formation.colBottom[col] * (uint32_t)formation.cols + col;
+}
+
+//grid cells whose alien could overlap the box [x, x + w) x [y, y + h). aliens never
+//stray more than one march step from their cell, so this is a tight broad phase.
+bool formationCells(const Formation& formation, int32_t x, int32_t y, int32_t w, int32_t h, size_t* col0, size_t* col1, size_t* row0, size_t* row1);
+
+//picks the alien that moves this tick and by how much, false once nothing is left to move
+bool formationStep(Formation* formation, uint32_t* alien, int32_t* dx, int32_t* dy);
@@ -0,0 +1,450 @@
+#include "game.h"
+#include "stats.h"
+#include "events.h"
+
+#include <cstring>
+#include <type_traits>
+
+const size_t alienDeathTicks = 10;
+const size_t playerRespawnTicks = 60;
+const uint32_t alienFireDelayMin = 20;
+const uint32_t alienFireDelayMax = 60;
+
+static_assert(std::is_trivially_copyable<Game>::value, "game state must stay copyable with memcpy");
+static_assert(sizeof(StateHeader) <= STATE_HEADER_SIZE, "state header outgrew its slot");
+
+//upper bound on shots in flight, so the fixed pool never has to drop one. a shot
+//lives at most height / 2 ticks, the player fires at most once a tick, the aliens
+//once per alienFireDelayMin and each bot once per fire interval.
+static size_t bulletBound(const GameConfig& config){
+    size_t lifetime = config.height / 2 + 1;
+    size_t players = config.versus ? 2 : 1;
+    return players * lifetime + lifetime / alienFireDelayMin + 1 + config.botNum * (lifetime / config.fireInterval + 1);
+}
+
+//carves the header, the game and every array it owns out of arena, in that order.
+//a measuring arena lays out into scratch instead and only sizes the block.
+static Game* gameLayout(Arena* arena, Game* scratch, const GameConfig& config){
+    arenaAlloc<uint8_t>(arena, STATE_HEADER_SIZE, 64);
+    Game* game = arenaAlloc<Game>(arena, 1, 64);
+    if (!game) game = scratch;
+
+    size_t alienNum = config.rows * config.cols;
+    size_t bulletCapacity = bulletBound(config);
+    if (bulletCapacity < config.bulletCapacity) bulletCapacity = config.bulletCapacity;
+
+    game->aliens = arenaAlloc<Alien>(arena, alienNum);
+    game->bots = config.botNum ? arenaAlloc<Bot>(arena, config.botNum) : nullptr;
+    bulletPoolInit(&game->bullets, arena, bulletCapacity);
+    //every alien can be dying at once, plus the fire timer and a respawn timer per player
+    size_t players = config.versus ? 2 : 1;
+    timerWheelInit(&game->timers, arena, alienNum + 1 + players);
+    animationInit(&game->animations, arena, alienNum);
+    formationInit(&game->formation, arena, config.rows, config.cols);
+    return game;
+}
+
+Game* gameCreate(const GameConfig& config, const Assets& assets){
+    Arena arena;
+    Game scratch;
+    arenaInit(&arena, nullptr, 0);
+    gameLayout(&arena, &scratch, config);
+
+    //zeroed so that padding is identical in every snapshot
+    size_t size = arena.used;
+    uint8_t* block = new uint8_t[size];
+    memset(block, 0, size);
+    arenaInit(&arena, block, size);
+    Game* game = gameLayout(&arena, &scratch, config);
+
+    StateHeader* header = gameHeader(game);
+    header->magic = STATE_MAGIC;
+    header->version = STATE_VERSION;
+    header->size = size;
+
+    game->width = config.width;
+    game->height = config.height;
+    game->alienNum = config.rows * config.cols;
+
+    for (size_t i = 0; i < game->alienNum; i++){
+        animationAdd(&game->animations, assets.alienAnimations, alienTypeOf(i / config.cols, config.rows) - 1, 0);
+    }
+
+    game->player.y = 32;
+    game->rival.y = game->player.y;
+    game->versus = config.versus;
+
+    game->formation.originX = 20;
+    game->formation.originY = 128;
+    game->formation.colSpacing = 16;
+    game->formation.rowSpacing = 17;
+    game->formation.cellWidth = (int32_t)assets.alienDeathSprite.width;
+    game->formation.cellHeight = (int32_t)assets.alienSprites[0].height;
+    game->formation.minX = 0;
+    game->formation.maxX = (int32_t)game->width;
+    game->formation.floorY = (int32_t)(game->player.y + assets.playerSprite.height);
+
+    game->botNum = config.botNum;
+    game->fireInterval = config.fireInterval;
+
+    gameReset(game, assets, config.seed);
+    return game;
+}
+
+void gameDestroy(Game* game){
+    if (game) delete[] (uint8_t*)gameHeader(game);
+}
+
+void gameReset(Game* game, const Assets& assets, uint64_t seed){
+    game->score = 0;
+    game->rivalScore = 0;
+    game->tick = 0;
+    bulletPoolClear(&game->bullets);
+    timerWheelClear(&game->timers);
+    formationReset(&game->formation);
+
+    game->player.x = game->versus ? game->width / 3 - 5 : game->width / 2 - 5;
+    game->player.lives = 3;
+    game->player.alive = true;
+
+    game->rival.x = game->width * 2 / 3 - 5;
+    game->rival.lives = game->versus ? 3 : 0;
+    game->rival.alive = game->versus;
+
+    for (size_t i = 0; i < SHIELD_COUNT; i++){
+        shieldInit(&game->shields[i], (int32_t)((32 + 45 * i) * game->width / 224), 48);
+    }
+
+    rngSeed(&game->rng, seed);
+    timerStart(&game->timers, alienFireDelayMax, TIMER_ALIEN_FIRE, 0);
+
+    size_t rows = game->formation.rows;
+    size_t cols = game->formation.cols;
+    for (size_t i = 0; i < rows; i++){
+        for (size_t j = 0; j < cols; j++){
+            size_t k = i * cols + j;
+            Alien& alien = game->aliens[k];
+            alien.type = alienTypeOf(i, rows);
+            animationSet(&game->animations, assets.alienAnimations, k, alien.type - 1, 0);
+
+            const Sprite& sprite = assets.alienSprites[2 * (alien.type - 1)];
+
+            alien.x = 16 * j + 20 + (assets.alienDeathSprite.width - sprite.width) / 2;
+            alien.y = 17 * i + 128;
+        }
+    }
+
+    //bots start spread across the screen with staggered cooldowns
+    for (size_t i = 0; i < game->botNum; i++){
+        Bot& bot = game->bots[i];
+        bot.x = (int32_t)rngRange(&game->rng, (uint32_t)(game->width - assets.playerSprite.width));
+        bot.dir = (i & 1) ? -1 : 1;
+        bot.cooldown = rngRange(&game->rng, game->fireInterval);
+    }
+}
+
+//hands an event to the ring attached to this thread, nearly free when there is none
+static void emitEvent(const Game* game, EventType type, uint8_t source, int32_t x, int32_t y, uint32_t value, uint32_t extra){
+    std::vector<GameEvent>* stage = eventsStaged();
+    EventRing* ring = eventsAttached();
+    if (!stage && !ring) return;
+
+    GameEvent event;
+    event.tick = game->tick;
+    event.type = type;
+    event.source = source;
+    event.reserved = 0;
+    event.x = x;
+    event.y = y;
+    event.value = value;
+    event.extra = extra;
+    event.padding = 0;
+    if (stage) stage->push_back(event);
+    else eventPush(ring, event);
+}
+
+static void killAlien(Game* game, const Assets& assets, size_t j, uint8_t owner){
+    Alien& alien = game->aliens[j];
+    const Sprite& alienSprite = animationSprite(assets.alienAnimations, game->animations, j);
+
+    size_t points = 10 * (4 - alien.type);
+    size_t& total = owner ? game->rivalScore : game->score;
+    total += points;
+    emitEvent(game, EVENT_ALIEN_KILLED, owner, (int32_t)alien.x, (int32_t)alien.y, (uint32_t)j, alien.type);
+    emitEvent(game, EVENT_SCORE, owner, 0, 0, (uint32_t)points, (uint32_t)total);
+    alien.type = ALIEN_EXPLODING;
+    alien.x -= (assets.alienDeathSprite.width - alienSprite.width) / 2;
+    timerStart(&game->timers, alienDeathTicks, TIMER_ALIEN_DEATH, (uint32_t)j);
+    formationKill(&game->formation, (uint32_t)j);
+}
+
+//lowest index live alien overlapping the bullet, only the grid cells around it are tested
+static bool findAlienHit(const Game& game, const Assets& assets, int32_t x, int32_t y, size_t* hit){
+    const Formation& formation = game.formation;
+    const Sprite& bulletSprite = assets.bulletSprite;
+
+    size_t col0, col1, row0, row1;
+    if (!formationCells(formation, x, y, (int32_t)bulletSprite.width, (int32_t)bulletSprite.height, &col0, &col1, &row0, &row1)) return false;
+
+    for (size_t row = row0; row <= row1; row++){
+        for (size_t col = col0; col <= col1; col++){
+            size_t j = row * formation.cols + col;
+            const Alien& alien = game.aliens[j];
+            if (alien.type == ALIEN_DEAD || alien.type == ALIEN_EXPLODING) continue;
+
+            const Sprite& alienSprite = animationSprite(assets.alienAnimations, game.animations, j);
+            if (spriteOverlap(bulletSprite, x, y, alienSprite, alien.x, alien.y)){
+                *hit = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void movePlayer(Game* game, Player* player, const Sprite& playerSprite, const GameInput& input, uint8_t owner){
+    int playerDir = player->alive ? 2 * input.dir : 0;
+
+    if (playerDir != 0){
+        if (player->x + playerSprite.width + playerDir >= game->width) {
+            player->x = game->width - playerSprite.width;
+        }
+        else if ((int)player->x + playerDir <= 0) {
+            player->x = 0;
+            playerDir *= -1;
+        }
+        else player->x += playerDir;
+    }
+
+    if (input.fire && player->alive){
+        int32_t x = (int32_t)(player->x + playerSprite.width / 2);
+        int32_t y = (int32_t)(player->y + playerSprite.height);
+        bulletSpawn(&game->bullets, x, y, 2, owner);
+        emitEvent(game, EVENT_SHOT, owner, x, y, 2, 0);
+    }
+}
+
+void gameStep(Game* game, const Assets& assets, const GameInput& input){
+    GameInput idle = {0, false};
+    gameStepVersus(game, assets, input, idle);
+}
+
+void gameStepVersus(Game* game, const Assets& assets, const GameInput& input, const GameInput& rivalInput){
+    const Sprite& bulletSprite = assets.bulletSprite;
+    const Sprite& playerSprite = assets.playerSprite;
+
+    //update animations
+    {
+        PHASE_SCOPE(PHASE_ANIMATION);
+        animationTick(&game->animations);
+    }
+
+    //march the formation, one alien per tick
+    {
+        PHASE_SCOPE(PHASE_MARCH);
+        uint32_t marcher;
+        int32_t marchX, marchY;
+        if (formationStep(&game->formation, &marcher, &marchX, &marchY)){
+            game->aliens[marcher].x += marchX;
+            game->aliens[marcher].y += marchY;
+        }
+        if (game->formation.invaded){
+            if (game->player.lives || game->rival.lives) emitEvent(game, EVENT_INVADED, EVENT_BY_ALIENS, 0, game->formation.floorY, 0, 0);
+            game->player.lives = game->rival.lives = 0;
+            game->player.alive = game->rival.alive = false;
+        }
+    }
+
+    //expire timed effects
+    {
+        PHASE_SCOPE(PHASE_TIMERS);
+        timerWheelAdvance(&game->timers);
+        TimerEvent timer;
+        while (timerPop(&game->timers, &timer)){
+            switch (timer.kind){
+            case TIMER_ALIEN_DEATH:
+                game->aliens[timer.payload].type = ALIEN_DEAD;
+                break;
+            case TIMER_ALIEN_FIRE:
+                //the lowest alien of a random live column shoots
+                if (game->formation.liveColNum && !game->formation.invaded){
+                    uint32_t shooter = formationShooter(game->formation, rngRange(&game->rng, (uint32_t)game->formation.liveColNum));
+                    const Alien& alien = game->aliens[shooter];
+                    const Sprite& sprite = animationSprite(assets.alienAnimations, game->animations, shooter);
+                    int32_t x = (int32_t)(alien.x + sprite.width / 2);
+                    int32_t y = (int32_t)(alien.y - bulletSprite.height);
+                    bulletSpawn(&game->bullets, x, y, -2, 0);
+                    emitEvent(game, EVENT_SHOT, EVENT_BY_ALIENS, x, y, (uint32_t)-2, 0);
+                }
+                timerStart(&game->timers, alienFireDelayMin + rngRange(&game->rng, alienFireDelayMax - alienFireDelayMin), TIMER_ALIEN_FIRE, 0);
+                break;
+            case TIMER_PLAYER_RESPAWN: {
+                //payload is the player index
+                Player& player = timer.payload ? game->rival : game->player;
+                player.alive = player.lives > 0;
+                if (player.alive) emitEvent(game, EVENT_PLAYER_RESPAWN, (uint8_t)timer.payload, (int32_t)player.x, (int32_t)player.y, (uint32_t)player.lives, 0);
+                break;
+            }
+            }
+        }
+    }
+
+    //update bullets
+    {
+        PHASE_SCOPE(PHASE_COLLISION);
+        BulletPool& bullets = game->bullets;
+        bulletPoolUpdate(&bullets, (int32_t)bulletSprite.height, (int32_t)game->height);
+
+        for (size_t i = 0; i < bullets.count; i++){
+            if (bullets.dead[i]) continue;
+
+            //check if shield hit, the shot carves a hole where it lands
+            bool blocked = false;
+            for (size_t k = 0; k < SHIELD_COUNT; k++){
+                Shield& shield = game->shields[k];
+                int32_t hitRow;
+                if (shieldHit(shield, bullets.x[i], bullets.y[i], (int32_t)bulletSprite.height, bullets.dir[i], &hitRow)){
+                    shieldErode(&shield, bullets.x[i] - shield.x, hitRow);
+                    bulletKill(&bullets, i);
+                    blocked = true;
+                    break;
+                }
+            }
+            if (blocked) continue;
+
+            //check if a player is hit
+            if (bullets.dir[i] < 0){
+                for (uint32_t k = 0; k < 2; k++){
+                    Player& player = k ? game->rival : game->player;
+                    if (player.alive && spriteOverlap(bulletSprite, bullets.x[i], bullets.y[i], playerSprite, player.x, player.y)){
+                        player.lives--;
+                        player.alive = false;
+                        emitEvent(game, EVENT_PLAYER_HIT, (uint8_t)k, (int32_t)player.x, (int32_t)player.y, (uint32_t)player.lives, 0);
+                        timerStart(&game->timers, playerRespawnTicks, TIMER_PLAYER_RESPAWN, k);
+                        bulletKill(&bullets, i);
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            //check if alien hit
+            size_t hit;
+            if (findAlienHit(*game, assets, bullets.x[i], bullets.y[i], &hit)){
+                killAlien(game, assets, hit, bullets.owner[i]);
+                bulletKill(&bullets, i);
+            }
+        }
+
+        bulletPoolCompact(&bullets);
+    }
+
+    //update player movement
+    {
+        PHASE_SCOPE(PHASE_PLAYER);
+        movePlayer(game, &game->player, playerSprite, input, 0);
+        if (game->versus) movePlayer(game, &game->rival, playerSprite, rivalInput, 1);
+
+        for (size_t i = 0; i < game->botNum; i++){
+            Bot& bot = game->bots[i];
+            bot.x += 2 * bot.dir;
+            if (bot.x <= 0 || bot.x + (int32_t)playerSprite.width >= (int32_t)game->width){
+                bot.dir = -bot.dir;
+                bot.x += 2 * bot.dir;
+            }
+
+            if (bot.cooldown){
+                bot.cooldown--;
+                continue;
+            }
+            bot.cooldown = game->fireInterval - 1;
+            int32_t y = (int32_t)(game->player.y + playerSprite.height);
+            bulletSpawn(&game->bullets, bot.x + (int32_t)playerSprite.width / 2, y, 2, 0);
+            emitEvent(game, EVENT_SHOT, EVENT_BY_BOT, bot.x + (int32_t)playerSprite.width / 2, y, 2, 0);
+        }
+    }
+
+    game->tick++;
+}
+
+void gameDraw(Buffer* buffer, const Game& game, const Assets& assets){
+    uint32_t clearColour = rgbToUint32(0, 0, 0);
+    uint32_t colour = rgbToUint32(0, 255, 0);
+    const Sprite& textSheet = assets.textSheet;
+    const Sprite& numberSheet = assets.numberSheet;
+
+    {
+        PHASE_SCOPE(PHASE_CLEAR);
+        clearBuffer(buffer, clearColour);
+    }
+
+    //draw text and score
+    {
+        PHASE_SCOPE(PHASE_HUD);
+        drawText(buffer, textSheet, "SCORE", 4, game.height - textSheet.height - 7, colour);
+        drawNumber(buffer, numberSheet, game.score, 4 + 2 * numberSheet.width, game.height - 2 * numberSheet.height - 12, colour);
+        drawText(buffer, textSheet, "CREDIT 00", game.width - 60, 7, colour);
+        drawNumber(buffer, numberSheet, game.player.lives, 4, 7, colour);
+        if (game.versus){
+            drawText(buffer, textSheet, "SCORE", game.width / 2, game.height - textSheet.height - 7, colour);
+            drawNumber(buffer, numberSheet, game.rivalScore, game.width / 2 + 2 * numberSheet.width, game.height - 2 * numberSheet.height - 12, colour);
+            drawNumber(buffer, numberSheet, game.rival.lives, 4 + 3 * numberSheet.width, 7, colour);
+        }
+
+        if (!game.player.lives && !game.rival.lives){
+            drawText(buffer, textSheet, "GAME OVER", game.width / 2 - 27, game.height / 2, colour);
+        }
+
+        for (size_t i = 0; i < game.width; i++){
+            buffer->data[game.width * 16 + i] = colour;
+        }
+    }
+
+    //draw aliens
+    {
+        PHASE_SCOPE(PHASE_DRAW_ALIENS);
+        for (size_t i = 0; i < game.alienNum; i++){
+            const Alien& alien = game.aliens[i];
+            if (alien.type == ALIEN_DEAD) continue;
+
+            if (alien.type == ALIEN_EXPLODING) {
+                drawSprite(buffer, assets.alienDeathSprite, alien.x, alien.y, colour);
+            }
+
+            else {
+                const Sprite& sprite = animationSprite(assets.alienAnimations, game.animations, i);
+                drawSprite(buffer, sprite, alien.x, alien.y, colour);
+            }
+        }
+    }
+
+    //draw shields
+    {
+        PHASE_SCOPE(PHASE_DRAW_SHIELDS);
+        for (size_t i = 0; i < SHIELD_COUNT; i++){
+            drawShield(buffer, game.shields[i], colour);
+        }
+    }
+
+    //draw player and bots
+    {
+        PHASE_SCOPE(PHASE_DRAW_PLAYER);
+        if (game.player.alive){
+            drawSprite(buffer, assets.playerSprite, game.player.x, game.player.y, colour);
+        }
+        if (game.rival.alive){
+            drawSprite(buffer, assets.playerSprite, game.rival.x, game.rival.y, colour);
+        }
+        for (size_t i = 0; i < game.botNum; i++){
+            drawSprite(buffer, assets.playerSprite, game.bots[i].x, game.player.y, colour);
+        }
+    }
+
+    //draw bullets
+    {
+        PHASE_SCOPE(PHASE_DRAW_BULLETS);
+        for (size_t i = 0; i < game.bullets.count; i++){
+            drawSprite(buffer, assets.bulletSprite, game.bullets.x[i], game.bullets.y[i], colour);
+        }
+    }
+}
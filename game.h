@@ -0,0 +1,127 @@
+#pragma once
+
+#include "render.h"
+#include "assets.h"
+#include "config.h"
+#include "bullets.h"
+#include "timers.h"
+#include "animation.h"
+#include "formation.h"
+#include "shields.h"
+#include "rng.h"
+
+struct Alien{
+    size_t x, y;
+    uint8_t type;
+};
+
+struct Player{
+    size_t x, y;
+    size_t lives;
+    bool alive;
+};
+
+//stress-mode shooter that sweeps the bottom of the screen firing on a fixed interval
+struct Bot{
+    int32_t x;
+    int32_t dir;
+    uint32_t cooldown;
+};
+
+#define STATE_MAGIC 0x54534953u //"SIST"
+#define STATE_VERSION 2
+#define STATE_HEADER_SIZE 64
+
+//a game and everything it owns live in one block: this header, the Game, then its
+//arrays. internal pointers are self-relative, so the whole block is trivially
+//copyable and position independent, a snapshot is one memcpy of size bytes.
+struct StateHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+};
+
+struct Game{
+    size_t width, height;
+    size_t alienNum;
+    RelPtr<Alien> aliens;
+    Player player;
+    Player rival; //second player of a versus game, never alive otherwise
+    BulletPool bullets;
+    TimerWheel timers;
+    AnimationSystem animations;
+    Formation formation;
+    Shield shields[SHIELD_COUNT];
+    Rng rng;
+    size_t score;
+    size_t rivalScore;
+    bool versus;
+    size_t botNum;
+    RelPtr<Bot> bots;
+    uint32_t fireInterval;
+    uint64_t tick;
+};
+
+enum AlienType : uint8_t{
+    ALIEN_DEAD = 0,
+    ALIEN_A = 1,
+    ALIEN_B = 2,
+    ALIEN_C = 3,
+    ALIEN_EXPLODING = 4
+};
+
+//rows are banded into the arcade's five, bottom two ALIEN_C, middle two ALIEN_B, top ALIEN_A
+inline uint8_t alienTypeOf(size_t row, size_t rows){
+    size_t band = row * 5 / rows;
+    return (uint8_t)((5 - band) / 2 + 1);
+}
+
+struct GameInput{
+    int dir;
+    bool fire;
+};
+
+//one byte form of GameInput for replays and agents, matches EnvAction
+enum InputBits : uint8_t{
+    INPUT_LEFT = 1,
+    INPUT_RIGHT = 2,
+    INPUT_FIRE = 4
+};
+
+inline uint8_t gameInputPack(const GameInput& input){
+    return (uint8_t)((input.dir < 0 ? INPUT_LEFT : 0) | (input.dir > 0 ? INPUT_RIGHT : 0) | (input.fire ? INPUT_FIRE : 0));
+}
+
+inline GameInput gameInputUnpack(uint32_t bits){
+    GameInput input;
+    input.dir = ((bits & INPUT_RIGHT) ? 1 : 0) - ((bits & INPUT_LEFT) ? 1 : 0);
+    input.fire = (bits & INPUT_FIRE) != 0;
+    return input;
+}
+
+Game* gameCreate(const GameConfig& config, const Assets& assets);
+void gameDestroy(Game* game);
+
+inline StateHeader* gameHeader(Game* game){
+    return (StateHeader*)((uint8_t*)game - STATE_HEADER_SIZE);
+}
+
+inline const StateHeader* gameHeader(const Game* game){
+    return (const StateHeader*)((const uint8_t*)game - STATE_HEADER_SIZE);
+}
+
+//restarts the game in place with a new seed, nothing is reallocated
+void gameReset(Game* game, const Assets& assets, uint64_t seed);
+
+//advances the simulation one tick
+void gameStep(Game* game, const Assets& assets, const GameInput& input);
+
+//advances a versus game one tick, both players move and fire in the same tick
+void gameStepVersus(Game* game, const Assets& assets, const GameInput& input, const GameInput& rivalInput);
+
+//draws the current state, the buffer must be game->width x game->height
+void gameDraw(Buffer* buffer, const Game& game, const Assets& assets);
+
+inline bool gameOver(const Game& game){
+    return (!game.player.lives && !game.rival.lives) || !game.formation.liveNum;
+}
@@ -0,0 +1,170 @@
+#include "heap.h"
+#include "stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#define HEAP_TAG_CAPACITY 64
+
+struct HeapTagStats{
+    atomic<const char*> tag;
+    atomic<uint64_t> allocations;
+    atomic<uint64_t> bytes;
+};
+
+static thread_local uint64_t allocations = 0;
+static thread_local const char* guarded = nullptr;
+static thread_local const char* tagged = nullptr;
+
+static atomic<uint64_t> live(0);
+static atomic<uint64_t> peak(0);
+static HeapTagStats tags[HEAP_TAG_CAPACITY];
+
+uint64_t heapAllocations(){
+    return allocations;
+}
+
+uint64_t heapLive(){
+    return live.load(memory_order_relaxed);
+}
+
+uint64_t heapPeak(){
+    return peak.load(memory_order_relaxed);
+}
+
+HeapGuard::HeapGuard(const char* name) : name(name), outer(guarded){
+    guarded = name;
+}
+
+HeapGuard::~HeapGuard(){
+    guarded = outer;
+}
+
+HeapTag::HeapTag(const char* tag) : outer(tagged){
+    tagged = tag;
+}
+
+HeapTag::~HeapTag(){
+    tagged = outer;
+}
+
+void heapPrintTags(FILE* file){
+    //a selection sort is plenty for a few dozen tags
+    bool printed[HEAP_TAG_CAPACITY] = {};
+    for (;;){
+        size_t best = HEAP_TAG_CAPACITY;
+        for (size_t i = 0; i < HEAP_TAG_CAPACITY; i++){
+            if (printed[i] || !tags[i].allocations.load()) continue;
+            if (best == HEAP_TAG_CAPACITY || tags[i].bytes.load() > tags[best].bytes.load()) best = i;
+        }
+        if (best == HEAP_TAG_CAPACITY) break;
+        printed[best] = true;
+
+        const char* tag = tags[best].tag.load();
+        fprintf(file, "  %-24s %10llu allocations %12.1f KB\n", tag ? tag : "untagged", (unsigned long long)tags[best].allocations.load(),
+            tags[best].bytes.load() / 1024.0);
+    }
+}
+
+#if HEAP_TRACK
+
+//every block carries its size in front, so delete can take it back off the live count.
+//16 bytes keep the user pointer as aligned as malloc's
+#define HEAP_HEADER 16
+
+//slot 0 collects untagged allocations. the others are claimed once and never released,
+//a full table lumps further tags into the last one
+static HeapTagStats& heapTagStats(const char* tag){
+    if (!tag) return tags[0];
+    for (size_t i = 1; i < HEAP_TAG_CAPACITY - 1; i++){
+        const char* current = tags[i].tag.load(memory_order_acquire);
+        if (current == tag) return tags[i];
+        if (!current){
+            const char* expected = nullptr;
+            if (tags[i].tag.compare_exchange_strong(expected, tag) || expected == tag) return tags[i];
+        }
+    }
+    return tags[HEAP_TAG_CAPACITY - 1];
+}
+
+static void* heapAllocate(size_t size, bool nothrow){
+    if (guarded){
+        //dropped first so that reporting cannot trip it again
+        const char* name = guarded;
+        guarded = nullptr;
+        fprintf(stderr, "heap allocation of %zu bytes inside %s\n", size, name);
+        abort();
+    }
+
+    uint8_t* block = (uint8_t*)malloc(size + HEAP_HEADER);
+    if (!block){
+        if (nothrow) return nullptr;
+        throw bad_alloc();
+    }
+    *(size_t*)block = size;
+
+    allocations++;
+    uint64_t now = live.fetch_add(size, memory_order_relaxed) + size;
+    uint64_t high = peak.load(memory_order_relaxed);
+    while (now > high && !peak.compare_exchange_weak(high, now, memory_order_relaxed)){}
+
+    HeapTagStats& stats = heapTagStats(tagged);
+    stats.allocations.fetch_add(1, memory_order_relaxed);
+    stats.bytes.fetch_add(size, memory_order_relaxed);
+    statsAllocation(size);
+    return block + HEAP_HEADER;
+}
+
+static void heapFree(void* memory){
+    if (!memory) return;
+    uint8_t* block = (uint8_t*)memory - HEAP_HEADER;
+    size_t size = *(size_t*)block;
+    live.fetch_sub(size, memory_order_relaxed);
+    statsFree(size);
+    free(block);
+}
+
+void* operator new(size_t size){
+    return heapAllocate(size, false);
+}
+
+void* operator new[](size_t size){
+    return heapAllocate(size, false);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept{
+    return heapAllocate(size, true);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept{
+    return heapAllocate(size, true);
+}
+
+void operator delete(void* memory) noexcept{
+    heapFree(memory);
+}
+
+void operator delete[](void* memory) noexcept{
+    heapFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept{
+    heapFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept{
+    heapFree(memory);
+}
+
+void operator delete(void* memory, const nothrow_t&) noexcept{
+    heapFree(memory);
+}
+
+void operator delete[](void* memory, const nothrow_t&) noexcept{
+    heapFree(memory);
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+//debug builds replace the global new and delete with a tracking allocator: every
+//allocation is counted against the running phase and frame (see stats.h) and against
+//the innermost HEAP_TAG, and code that must not touch the heap can say so with
+//HEAP_GUARD_SCOPE. define HEAP_TRACK to 0 or 1 to override the default
+#if !defined(HEAP_TRACK)
+#if defined(_DEBUG)
+#define HEAP_TRACK 1
+#else
+#define HEAP_TRACK 0
+#endif
+#endif
+
+//global allocations made by the calling thread, always 0 without HEAP_TRACK
+uint64_t heapAllocations();
+
+//bytes allocated and not yet freed across all threads, and the most there have been
+uint64_t heapLive();
+uint64_t heapPeak();
+
+//allocation counts and bytes per tag, largest first
+void heapPrintTags(FILE* file);
+
+//while a guard lives on a thread, any allocation on that thread is reported with the
+//guard's name and aborts, so a debugger stops on the offending call
+struct HeapGuard{
+    const char* name;
+    const char* outer;
+
+    HeapGuard(const char* name);
+    ~HeapGuard();
+};
+
+//attributes allocations on this thread to a call site until the scope ends. tags are
+//compared by address, so pass a string literal
+struct HeapTag{
+    const char* outer;
+
+    HeapTag(const char* tag);
+    ~HeapTag();
+};
+
+#define HEAP_CONCAT2(a, b) a##b
+#define HEAP_CONCAT(a, b) HEAP_CONCAT2(a, b)
+#if HEAP_TRACK
+#define HEAP_GUARD_SCOPE(name) HeapGuard HEAP_CONCAT(heapGuard, __LINE__)(name)
+#define HEAP_TAG(tag) HeapTag HEAP_CONCAT(heapTag, __LINE__)(tag)
+#else
+#define HEAP_GUARD_SCOPE(name) ((void)0)
+#define HEAP_TAG(tag) ((void)0)
+#endif
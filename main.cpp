@@ -4,65 +4,30 @@
 #include <GLFW/glfw3.h>
 #include <thread>
 #include <chrono>
+#include <string>
+#include "game.h"
+#include "stats.h"
+#include "batch.h"
+#include "bridge.h"
+#include "replay.h"
+#include "checksum.h"
+#include "verify.h"
+#include "snapshot.h"
+#include "rewind.h"
+#include "netplay.h"
+#include "spectate.h"
+#include "events.h"
+#include "heap.h"
+#include "atlas.h"
+#include "scenario.h"
+#include "trace.h"
 
 using namespace std;
 
-#define MAX_BULLETS 128
-
 //global variables for player input
 int inputDir = 0;
 bool fire = 0;
-
-size_t score = 0;
-
-struct Buffer{
-    size_t width, height;
-    uint32_t* data;
-};
-
-struct Sprite{
-    size_t width, height;
-    uint8_t* data;
-};
-
-struct Alien{
-    size_t x, y;
-    uint8_t type;
-};
-
-struct Player{
-    size_t x, y;
-    size_t lives;
-};
-
-struct Bullet {
-    size_t x, y;
-    int dir;
-};
-
-struct Game{
-    size_t width, height;
-    size_t alienNum;
-    size_t bulletNum;
-    Alien* aliens;
-    Player player;
-    Bullet bullets[MAX_BULLETS];
-};
-
-struct SpriteAnimation{
-    bool loop;
-    size_t frameNum;
-    size_t frameDuration;
-    size_t time;
-    Sprite** frames;
-};
-
-enum AlienType : uint8_t{
-    ALIEN_DEAD = 0,
-    ALIEN_A = 1,
-    ALIEN_B = 2,
-    ALIEN_C = 3
-};
+bool rewinding = false;
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height){
     glViewport(0, 0, width, height);
@@ -84,68 +49,13 @@ void processInput(GLFWwindow* window, int key, int scancode, int action, int mod
     case GLFW_KEY_SPACE:
         if (action == GLFW_PRESS) fire = true;
         break;
+    case GLFW_KEY_BACKSPACE:
+        if (action == GLFW_PRESS) rewinding = true;
+        else if (action == GLFW_RELEASE) rewinding = false;
+        break;
     }
 }
 
-void clearBuffer(Buffer* buffer, uint32_t colour){
-    for (size_t i = 0; i < buffer->width * buffer->height; i++)    {
-        buffer->data[i] = colour;
-    }
-}
-
-void drawSprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t colour){
-    for (size_t i = 0; i < sprite.width; i++){
-        for (size_t j = 0; j < sprite.height; j++){
-            if (sprite.data[j * sprite.width + i] && (sprite.height - 1 + y - j) < buffer->height && (x + i) < buffer->width){
-                buffer->data[(sprite.height - 1 + y - j) * buffer->width + (x + i)] = colour;
-            }
-        }
-    }
-}
-
-void drawText(Buffer* buffer, const Sprite& textSheet, const char* text, size_t x, size_t y, uint32_t colour){
-    size_t xp = x;
-    size_t stride = textSheet.width * textSheet.height;
-    Sprite sprite = textSheet;
-    for (const char* charp = text; *charp != '\0'; ++charp){
-        char character = *charp - 32;
-        if (character < 0 || character >= 65) continue;
-
-        sprite.data = textSheet.data + character * stride;
-        drawSprite(buffer, sprite, xp, y, colour);
-        xp += sprite.width + 1;
-    }
-}
-
-void drawNumber(Buffer* buffer, const Sprite& numberSheet, size_t number, size_t x, size_t y, uint32_t colour){
-    uint8_t digits[64];
-    size_t numDigits = 0;
-
-    size_t currentNum = number;
-    do{
-        digits[numDigits++] = currentNum % 10;
-        currentNum = currentNum / 10;
-    } while (currentNum > 0);
-
-    size_t xp = x;
-    size_t stride = numberSheet.width * numberSheet.height;
-    Sprite sprite = numberSheet;
-    for (size_t i = 0; i < numDigits; i++){
-        uint8_t digit = digits[numDigits - i - 1];
-        sprite.data = numberSheet.data + digit * stride;
-        drawSprite(buffer, sprite, xp, y, colour);
-        xp += sprite.width + 1;
-    }
-}
-
-uint32_t rgbToUint32(uint8_t r, uint8_t g, uint8_t b){
-    return (r << 24) | (g << 16) | (b << 8) | 255;
-}
-
-bool spriteOverlap(const Sprite& sprite1, size_t x1, size_t y1, const Sprite& sprite2, size_t x2, size_t y2){
-    return (x1 < x2 + sprite2.width && x1 + sprite1.width > x2 && y1 < y2 + sprite2.height && y1 + sprite1.height > y2);
-}
-
 const char* vertexShader =
     "\n"
     "#version 330\n"
@@ -173,475 +83,825 @@ const char* fragmentShader =
     "    outColor = texture(buffer, TexCoord).rgb;\n"
     "}\n";
 
-const size_t bufferWidth = 224;
-const size_t bufferHeight = 256;
+const size_t maxWindowSize = 1024;
 const int frameDelay = 1000 / 60 + 1; //60fps
 
-int main(){
-    //create alien sprites
-    Sprite alienSprites[6];
-
-    alienSprites[0].width = 8;
-    alienSprites[0].height = 8;
-    alienSprites[0].data = new uint8_t[8 * 8]{
-        0,0,0,1,1,0,0,0, // ...@@...
-        0,0,1,1,1,1,0,0, // ..@@@@..
-        0,1,1,1,1,1,1,0, // .@@@@@@.
-        1,1,0,1,1,0,1,1, // @@.@@.@@
-        1,1,1,1,1,1,1,1, // @@@@@@@@
-        0,1,0,1,1,0,1,0, // .@.@@.@.
-        1,0,0,0,0,0,0,1, // @......@
-        0,1,0,0,0,0,1,0  // .@....@.
-    };
-
-    alienSprites[1].width = 8;
-    alienSprites[1].height = 8;
-    alienSprites[1].data = new uint8_t[8 * 8]{
-        0,0,0,1,1,0,0,0, // ...@@...
-        0,0,1,1,1,1,0,0, // ..@@@@..
-        0,1,1,1,1,1,1,0, // .@@@@@@.
-        1,1,0,1,1,0,1,1, // @@.@@.@@
-        1,1,1,1,1,1,1,1, // @@@@@@@@
-        0,0,1,0,0,1,0,0, // ..@..@..
-        0,1,0,1,1,0,1,0, // .@.@@.@.
-        1,0,1,0,0,1,0,1  // @.@..@.@
-    };
-
-    alienSprites[2].width = 11;
-    alienSprites[2].height = 8;
-    alienSprites[2].data = new uint8_t[11 * 8]{
-        0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-        0,0,0,1,0,0,0,1,0,0,0, // ...@...@...
-        0,0,1,1,1,1,1,1,1,0,0, // ..@@@@@@@..
-        0,1,1,0,1,1,1,0,1,1,0, // .@@.@@@.@@.
-        1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-        1,0,1,1,1,1,1,1,1,0,1, // @.@@@@@@@.@
-        1,0,1,0,0,0,0,0,1,0,1, // @.@.....@.@
-        0,0,0,1,1,0,1,1,0,0,0  // ...@@.@@...
-    };
-
-    alienSprites[3].width = 11;
-    alienSprites[3].height = 8;
-    alienSprites[3].data = new uint8_t[11 * 8]{
-        0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-        1,0,0,1,0,0,0,1,0,0,1, // @..@...@..@
-        1,0,1,1,1,1,1,1,1,0,1, // @.@@@@@@@.@
-        1,1,1,0,1,1,1,0,1,1,1, // @@@.@@@.@@@
-        1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-        0,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@.
-        0,0,1,0,0,0,0,0,1,0,0, // ..@.....@..
-        0,1,0,0,0,0,0,0,0,1,0  // .@.......@.
-    };
-
-    alienSprites[4].width = 12;
-    alienSprites[4].height = 8;
-    alienSprites[4].data = new uint8_t[12 * 8]{
-        0,0,0,0,1,1,1,1,0,0,0,0, // ....@@@@....
-        0,1,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@@.
-        1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-        1,1,1,0,0,1,1,0,0,1,1,1, // @@@..@@..@@@
-        1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-        0,0,0,1,1,0,0,1,1,0,0,0, // ...@@..@@...
-        0,0,1,1,0,1,1,0,1,1,0,0, // ..@@.@@.@@..
-        1,1,0,0,0,0,0,0,0,0,1,1  // @@........@@
-    };
-
-
-    alienSprites[5].width = 12;
-    alienSprites[5].height = 8;
-    alienSprites[5].data = new uint8_t[12 * 8]{
-        0,0,0,0,1,1,1,1,0,0,0,0, // ....@@@@....
-        0,1,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@@.
-        1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-        1,1,1,0,0,1,1,0,0,1,1,1, // @@@..@@..@@@
-        1,1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@@
-        0,0,1,1,1,0,0,1,1,1,0,0, // ..@@@..@@@..
-        0,1,1,0,0,1,1,0,0,1,1,0, // .@@..@@..@@.
-        0,0,1,1,0,0,0,0,1,1,0,0  // ..@@....@@..
-    };
-
-    Sprite alienDeathSprite;
-    alienDeathSprite.width = 13;
-    alienDeathSprite.height = 7;
-    alienDeathSprite.data = new uint8_t[13 * 7]{
-        0,1,0,0,1,0,0,0,1,0,0,1,0, // .@..@...@..@.
-        0,0,1,0,0,1,0,1,0,0,1,0,0, // ..@..@.@..@..
-        0,0,0,1,0,0,0,0,0,1,0,0,0, // ...@.....@...
-        1,1,0,0,0,0,0,0,0,0,0,1,1, // @@.........@@
-        0,0,0,1,0,0,0,0,0,1,0,0,0, // ...@.....@...
-        0,0,1,0,0,1,0,1,0,0,1,0,0, // ..@..@.@..@..
-        0,1,0,0,1,0,0,0,1,0,0,1,0  // .@..@...@..@.
-    };
-
-    //player sprite
-    Sprite playerSprite;
-    playerSprite.width = 11;
-    playerSprite.height = 7;
-    playerSprite.data = new uint8_t[11 * 7]{
-        0,0,0,0,0,1,0,0,0,0,0, // .....@.....
-        0,0,0,0,1,1,1,0,0,0,0, // ....@@@....
-        0,0,0,0,1,1,1,0,0,0,0, // ....@@@....
-        0,1,1,1,1,1,1,1,1,1,0, // .@@@@@@@@@.
-        1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-        1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-        1,1,1,1,1,1,1,1,1,1,1, // @@@@@@@@@@@
-    };
-
-    //bullet sprite
-    Sprite bulletSprite;
-    bulletSprite.width = 1;
-    bulletSprite.height = 3;
-    bulletSprite.data = new uint8_t[3]{
-        1, // @
-        1, // @
-        1  // @
-    };
-
-    //text and number spritesheets
-    Sprite textSheet;
-    textSheet.width = 5;
-    textSheet.height = 7;
-    textSheet.data = new uint8_t[65 * 35]{
-        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,
-        0,1,0,1,0,0,1,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-        0,1,0,1,0,0,1,0,1,0,1,1,1,1,1,0,1,0,1,0,1,1,1,1,1,0,1,0,1,0,0,1,0,1,0,
-        0,0,1,0,0,0,1,1,1,0,1,0,1,0,0,0,1,1,1,0,0,0,1,0,1,0,1,1,1,0,0,0,1,0,0,
-        1,1,0,1,0,1,1,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,1,1,0,1,0,1,1,
-        0,1,1,0,0,1,0,0,1,0,1,0,0,1,0,0,1,1,0,0,1,0,0,1,0,1,0,0,0,1,0,1,1,1,1,
-        0,0,0,1,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,
-        1,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,
-        0,0,1,0,0,1,0,1,0,1,0,1,1,1,0,0,0,1,0,0,0,1,1,1,0,1,0,1,0,1,0,0,1,0,0,
-        0,0,0,0,0,0,0,1,0,0,0,0,1,0,0,1,1,1,1,1,0,0,1,0,0,0,0,1,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,1,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,
-        0,0,0,1,0,0,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,
-
-        0,1,1,1,0,1,0,0,0,1,1,0,0,1,1,1,0,1,0,1,1,1,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        0,0,1,0,0,0,1,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,1,1,0,
-        0,1,1,1,0,1,0,0,0,1,0,0,0,0,1,0,0,1,1,0,0,1,0,0,0,1,0,0,0,0,1,1,1,1,1,
-        1,1,1,1,1,0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        0,0,0,1,0,0,0,1,1,0,0,1,0,1,0,1,0,0,1,0,1,1,1,1,1,0,0,0,1,0,0,0,0,1,0,
-        1,1,1,1,1,1,0,0,0,0,1,1,1,1,0,0,0,0,0,1,0,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,0,1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        1,1,1,1,1,0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,1,0,1,1,1,1,0,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-
-        0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,1,0,0,
-        0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,
-        0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,
-        1,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,
-        0,1,1,1,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,1,0,1,1,1,0,1,1,1,0,1,0,0,1,0,0,0,1,0,1,1,1,0,
-
-        0,0,1,0,0,0,1,0,1,0,1,0,0,0,1,1,0,0,0,1,1,1,1,1,1,1,0,0,0,1,1,0,0,0,1,
-        1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,1,1,1,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,0,1,1,1,0,
-        1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,1,1,1,0,
-        1,1,1,1,1,1,0,0,0,0,1,0,0,0,0,1,1,1,1,0,1,0,0,0,0,1,0,0,0,0,1,1,1,1,1,
-        1,1,1,1,1,1,0,0,0,0,1,0,0,0,0,1,1,1,1,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,0,1,0,1,1,1,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,1,1,1,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,
-        0,1,1,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,1,1,1,0,
-        0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        1,0,0,0,1,1,0,0,1,0,1,0,1,0,0,1,1,0,0,0,1,0,1,0,0,1,0,0,1,0,1,0,0,0,1,
-        1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,1,1,1,1,
-        1,0,0,0,1,1,1,0,1,1,1,0,1,0,1,1,0,1,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,
-        1,0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,0,1,0,1,1,0,0,1,1,1,0,0,0,1,1,0,0,0,1,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,1,1,1,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,1,0,1,1,0,0,1,1,0,1,1,1,1,
-        1,1,1,1,0,1,0,0,0,1,1,0,0,0,1,1,1,1,1,0,1,0,1,0,0,1,0,0,1,0,1,0,0,0,1,
-        0,1,1,1,0,1,0,0,0,1,1,0,0,0,0,0,1,1,1,0,1,0,0,0,1,0,0,0,0,1,0,1,1,1,0,
-        1,1,1,1,1,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,
-        1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,0,1,1,1,0,
-        1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,0,1,0,1,0,0,0,1,0,0,
-        1,0,0,0,1,1,0,0,0,1,1,0,0,0,1,1,0,1,0,1,1,0,1,0,1,1,1,0,1,1,1,0,0,0,1,
-        1,0,0,0,1,1,0,0,0,1,0,1,0,1,0,0,0,1,0,0,0,1,0,1,0,1,0,0,0,1,1,0,0,0,1,
-        1,0,0,0,1,1,0,0,0,1,0,1,0,1,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,
-        1,1,1,1,1,0,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,0,1,1,1,1,1,
-
-        0,0,0,1,1,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,0,1,1,
-        0,1,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,1,0,
-        1,1,0,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1,0,0,1,1,0,0,0,
-        0,0,1,0,0,0,1,0,1,0,1,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,
-        0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
-    };
-
-    Sprite numberSheet = textSheet;
-    numberSheet.data += 16 * 35;
-
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    //create window
-    GLFWwindow* window = glfwCreateWindow(bufferWidth, bufferHeight, "space invaders", NULL, NULL);
-    if (window == NULL){
-        cout << "Failed to create GLFW window" << endl;
-        glfwTerminate();
-        return -1;
+//steps many games in lockstep lanes and reports throughput
+static void runBatch(const GameConfig& config, const Assets& assets){
+    BatchSim sim;
+    batchInit(&sim, config.batchNum, config, assets);
+
+    size_t threads = config.threads ? config.threads : thread::hardware_concurrency();
+    size_t ticks = config.ticks ? config.ticks : 1000;
+    double seconds = batchRun(&sim, ticks, threads, config.seed);
+
+    //the lanes past batchNum only pad the last block, they are stepped but not counted
+    double steps = (double)config.batchNum * ticks;
+    long long score = 0;
+    for (size_t i = 0; i < config.batchNum; i++){
+        score += sim.score[i];
     }
 
-    glfwMakeContextCurrent(window);
+    cout << config.batchNum << " games x " << ticks << " ticks on " << threads << " threads: " << seconds << " s, " << steps / seconds << " steps/s" << endl;
+    cout << "total score " << score << endl;
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
-        cout << "Failed to initialize GLAD" << endl;
-        return -1;
+    batchFree(&sim);
+}
+
+//answers agent actions until told to quit, frames are drawn straight into shared memory
+static void bridgeServe(Bridge* bridge, Game* game, const Assets& assets){
+    Buffer buffer;
+    buffer.width = game->width;
+    buffer.height = game->height;
+    buffer.data = bridgeFrame(*bridge);
+
+    bridgePublish(bridge, *game, 0);
+    for (;;){
+        uint32_t action = bridgeWaitAction(bridge);
+        if (action & BRIDGE_QUIT) break;
+
+        size_t score = game->score;
+        if (action & BRIDGE_RESET){
+            gameReset(game, assets, bridge->header->seed);
+            score = 0;
+        }
+        else {
+            gameStep(game, assets, gameInputUnpack(action));
+        }
+        if (action & BRIDGE_DRAW) gameDraw(&buffer, *game, assets);
+
+        bridgePublish(bridge, *game, (int32_t)(game->score - score));
     }
+}
 
-    glViewport(0, 0, bufferWidth, bufferHeight);
+static bool runBridgeHost(const GameConfig& config, const Assets& assets, Game* game){
+    Bridge bridge;
+    if (!bridgeCreate(&bridge, config.bridgeName, *game, config.spin)) return false;
+    cout << "serving " << bridge.shared.name << endl;
+    bridgeServe(&bridge, game, assets);
+    bridgeClose(&bridge);
+    return true;
+}
 
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+//random agent, resets whenever a game ends and stops the host when done
+static bool runBridgeAgent(const GameConfig& config){
+    Bridge bridge;
+    if (!bridgeOpen(&bridge, config.bridgeName)) return false;
+
+    Rng rng;
+    rngSeed(&rng, config.seed);
+    size_t ticks = config.ticks ? config.ticks : 100000;
+    uint32_t draw = config.headless ? 0 : (uint32_t)BRIDGE_DRAW;
+    uint64_t score = 0;
+
+    uint64_t start = statsNow();
+    for (size_t i = 0; i < ticks; i++){
+        uint32_t action = rngRange(&rng, 8) | draw;
+        if (bridge.header->state.done){
+            bridge.header->seed = rngNext(&rng);
+            action = BRIDGE_RESET | draw;
+        }
+        bridgeStep(&bridge, action);
+        score += bridge.header->state.reward > 0 ? bridge.header->state.reward : 0;
+    }
+    double seconds = (statsNow() - start) * 1e-9;
+    bridgeQuit(&bridge);
 
-    //turn on vsync
-    glfwSwapInterval(1);
+    cout << ticks << " round trips in " << seconds << " s, " << ticks / seconds << " steps/s, " << seconds * 1e6 / ticks << " us each" << endl;
+    cout << "total score " << score << endl;
 
-    //create buffer
-    uint32_t clearColour = rgbToUint32(0, 0, 0);
+    bridgeClose(&bridge);
+    return true;
+}
+
+//host on a second thread of this process, measures the handshake without process startup noise
+static bool runBridgeBench(GameConfig config, const Assets& assets, Game* game){
+    Bridge bridge;
+    if (!bridgeCreate(&bridge, config.bridgeName, *game, config.spin)) return false;
+
+    //the host publishes the first state, wait for it before attaching
+    thread host(bridgeServe, &bridge, game, cref(assets));
+    while (bridge.header->seq.load() & 1) this_thread::yield();
+
+    bool ok = runBridgeAgent(config);
+    if (!ok) bridgeQuit(&bridge);
+    host.join();
+    bridgeClose(&bridge);
+    return ok;
+}
+
+//replay, checksum and rewind streams attached to a run, every part is optional
+struct Session{
+    ReplayReader* play;
+    ReplayWriter* record;
+    ChecksumReader* expected;
+    ChecksumWriter* checksums;
+    RewindBuffer* rewind;
+    SpectateServer* broadcast;
+    bool frames;
+};
+
+//input of the next tick from the replay, false once it has run out
+static bool sessionInput(Session* session, GameInput* input){
+    return !session->play || replayNext(session->play, input);
+}
+
+//records the tick just simulated from input, frame is what was drawn before the step
+static void sessionTick(Session* session, const GameInput& input, const Game& game, const Buffer& frame){
+    if (session->record) replayWrite(session->record, input);
+    if (session->rewind) rewindPush(session->rewind, game, input);
+    if (session->broadcast) spectateSubmit(session->broadcast, frame, game.tick - 1);
+    if (!session->expected && !session->checksums) return;
+
+    ChecksumRecord record;
+    checksumGame(game, session->frames ? &frame : nullptr, &record);
+    if (session->checksums) checksumWrite(session->checksums, record);
+    if (session->expected) checksumVerify(session->expected, game.tick - 1, record);
+}
+
+//simulates and draws into the buffer as fast as possible, without a window. input comes from
+//the replay being played, if any
+static void runHeadless(Game* game, const Assets& assets, Buffer* buffer, const GameConfig& config, Session* session){
+    GameInput input = {0, false};
+    for (;;){
+        if (config.ticks ? game->tick >= config.ticks : !session->play && gameOver(*game)) break;
+        if (!sessionInput(session, &input)) break;
+
+        {
+            HEAP_GUARD_SCOPE("the headless frame loop");
+            gameDraw(buffer, *game, assets);
+            gameStep(game, assets, input);
+        }
+        sessionTick(session, input, *game, *buffer);
+        statsEndFrame();
+    }
+}
+
+//steps two games with the same input and stops at the first tick where their state differs
+//false on a divergence between the instances or from the recorded checksums. frames are
+//drawn from the first instance when the recording hashed them
+static bool runLockstep(const GameConfig& config, const Assets& assets, Buffer* buffer, Session* session){
+    Game* games[2] = {gameCreate(config, assets), gameCreate(config, assets)};
+
+    GameInput input = {0, false};
+    bool same = true;
+    while (same){
+        if (config.ticks ? games[0]->tick >= config.ticks : !session->play && gameOver(*games[0])) break;
+        if (!sessionInput(session, &input)) break;
+
+        if (session->frames) gameDraw(buffer, *games[0], assets);
+        ChecksumRecord records[2];
+        for (size_t i = 0; i < 2; i++){
+            gameStep(games[i], assets, input);
+            checksumGame(*games[i], session->frames && !i ? buffer : nullptr, &records[i]);
+        }
+        if (session->expected) checksumVerify(session->expected, games[0]->tick - 1, records[0]);
+
+        if (records[0].state != records[1].state){
+            cout << "instances diverged at tick " << games[0]->tick - 1 << endl;
+            gameDiff(*games[0], *games[1], stdout);
+            same = false;
+        }
+    }
+    if (same) cout << games[0]->tick << " ticks identical across instances" << endl;
+
+    gameDestroy(games[0]);
+    gameDestroy(games[1]);
+    return same && !(session->expected && session->expected->diverged);
+}
+
+//prints what the history costs, then checks that restores are exact and take bounded time
+static void rewindReport(RewindBuffer* rewind, Game* game, const Assets& assets){
+    uint64_t kept = rewind->newest - rewind->oldest + 1;
+    size_t bytes = rewindBytes(*rewind);
+    cout << "rewind: " << kept << " ticks in " << bytes / 1024 << " KB, " << bytes / (kept / 3600.0) / (1024 * 1024) << " MB per minute, "
+         << (double)rewind->stateSize * kept / bytes << "x smaller than full states" << endl;
+
+    ChecksumRecord latest, record;
+    checksumGame(*game, nullptr, &latest);
+
+    //every restore decodes one keyframe and at most one delta, wherever it lands
+    const size_t samples = 64;
+    uint64_t total = 0, worst = 0;
+    for (size_t i = 0; i < samples; i++){
+        uint64_t start = statsNow();
+        rewindRestore(rewind, game, rewind->oldest + (kept - 1) * i / (samples - 1));
+        uint64_t elapsed = statsNow() - start;
+        total += elapsed;
+        if (elapsed > worst) worst = elapsed;
+    }
+    cout << "restore " << total / samples * 1e-3 << " us average, " << worst * 1e-3 << " us worst" << endl;
+
+    //re-simulating the recorded input from the oldest tick must arrive at the same state,
+    //without emitting its events a second time
+    EventRing* events = eventsAttached();
+    eventsAttach(nullptr);
+    rewindRestore(rewind, game, rewind->oldest);
+    while (game->tick < rewind->newest){
+        gameStep(game, assets, rewindInput(*rewind, game->tick + 1));
+    }
+    eventsAttach(events);
+    checksumGame(*game, nullptr, &record);
+    cout << "re-simulated " << kept - 1 << " ticks from tick " << rewind->oldest << ", " << (record.state == latest.state ? "state matches" : "state differs") << endl;
+}
+
+//binds the versus side self plays, player one listens on the configured port and player two on the next
+static bool netOpen(NetPeer* peer, const GameConfig& config, Game* game, const Assets& assets, uint32_t self){
+    uint16_t port = config.netPort;
+    uint16_t localPort = self ? port + 1 : port;
+    uint16_t remotePort = self ? port : port + 1;
+    if (!netPeerInit(peer, game, assets, self, localPort, remotePort, config.rollbackWindow, config.netDelay, config.netLoss)) return false;
+    cout << "player " << self + 1 << " on udp " << localPort << ", peer on " << remotePort << endl;
+    return true;
+}
+
+//keeps exchanging after the last tick until both sides hold every input, then a
+//while longer so the remote sees our final acknowledgement
+static bool netFinish(NetPeer* peer, const GameConfig& config){
+    uint64_t start = statsNow();
+    bool settled = false;
+    while (!settled && statsNow() - start < 5000000000ull){
+        settled = netSettle(peer);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    uint64_t linger = statsNow() + (2 * (uint64_t)config.netDelay + 100) * 1000000;
+    while (statsNow() < linger){
+        netSettle(peer);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return settled;
+}
+
+static void netReport(const NetPeer& peer, uint64_t state){
+    const NetStats& stats = peer.stats;
+    const NetLink& link = peer.link;
+    double rollbacks = stats.rollbacks ? (double)stats.rollbacks : 1;
+    double frames = stats.frames ? (double)stats.frames : 1;
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)state);
+
+    cout << "player " << peer.self + 1 << ": " << stats.frames << " ticks, " << stats.stalls << " stalls, " << stats.rollbacks << " rollbacks ("
+         << 100.0 * stats.rollbacks / frames << "% of ticks), depth " << stats.resimTicks / rollbacks << " mean " << stats.maxDepth << " max, resim "
+         << stats.resimNs * 1e-3 / rollbacks << " us mean " << stats.maxResimNs * 1e-3 << " us max, " << stats.resimNs * 1e-3 / frames << " us per tick" << endl;
+    cout << "player " << peer.self + 1 << ": " << link.sent << " packets sent, " << link.dropped << " dropped, " << link.received << " received, score "
+         << (peer.self ? peer.game->rivalScore : peer.game->score) << ", state " << hex << endl;
+}
+
+//plays one headless side of a versus game at 60Hz with random held input
+static bool runVersus(const GameConfig& config, Game* game, const Assets& assets, uint32_t self, uint64_t* state){
+    NetPeer peer;
+    if (!netOpen(&peer, config, game, assets, self)) return false;
+
+    Rng rng;
+    rngSeed(&rng, config.seed + self + 1);
+    size_t ticks = config.ticks ? config.ticks : 1200;
+    GameInput input = {0, false};
+    chrono::steady_clock::time_point next = chrono::steady_clock::now();
+    while (game->tick < ticks){
+        if (game->tick % 8 == 0) input = gameInputUnpack(rngRange(&rng, 8));
+        netFrame(&peer, input);
+        statsEndFrame();
+        next += chrono::microseconds(1000000 / 60);
+        this_thread::sleep_until(next);
+    }
+
+    bool settled = netFinish(&peer, config);
+    ChecksumRecord record;
+    checksumGame(*game, nullptr, &record);
+    *state = record.state;
+    netReport(peer, record.state);
+    if (!settled) cout << "player " << self + 1 << ": peer stopped answering before every input arrived" << endl;
+    netPeerFree(&peer);
+    return settled;
+}
+
+static void versusSide(const GameConfig& config, Game* game, const Assets& assets, uint32_t self, uint64_t* state, bool* ok){
+    *ok = runVersus(config, game, assets, self, state);
+}
+
+//both sides on two threads over loopback, their final states have to agree
+static bool runVersusBench(const GameConfig& config, const Assets& assets){
+    Game* games[2] = {gameCreate(config, assets), gameCreate(config, assets)};
+    uint64_t states[2] = {0, 1};
+    bool ok[2] = {false, false};
+
+    thread rival(versusSide, cref(config), games[1], cref(assets), 1, &states[1], &ok[1]);
+    versusSide(config, games[0], assets, 0, &states[0], &ok[0]);
+    rival.join();
+
+    bool same = ok[0] && ok[1] && states[0] == states[1];
+    if (same) cout << "both sides agree after " << games[0]->tick << " ticks" << endl;
+    else cout << "sides disagree" << endl;
+
+    gameDestroy(games[0]);
+    gameDestroy(games[1]);
+    return same;
+}
+
+static void broadcastReport(const SpectateServer& server){
+    const SpectateStats& stats = server.stats;
+    double encoded = stats.encoded ? (double)stats.encoded : 1;
+    size_t raw = server.width * server.height * sizeof(uint32_t);
+    cout << "broadcast: " << stats.encoded << " of " << stats.submitted << " frames encoded, " << stats.keyframes << " keyframes, "
+         << stats.bytes / encoded << " bytes per frame against " << raw << " raw, encoding and sending " << stats.encodeNs * 1e-3 / encoded << " us mean "
+         << stats.maxEncodeNs * 1e-3 << " us max" << endl;
+}
+
+static void spectatorReport(const SpectateClient& client, double seconds){
+    double frames = client.frames ? (double)client.frames : 1;
+    cout << "spectated " << client.frames << " frames in " << seconds << " s, " << client.bytes / frames << " bytes per frame, "
+         << client.mismatches << " frames differed from the source" << endl;
+}
+
+//counts and checks frames without showing them
+static void runSpectator(SpectateClient* client){
     Buffer buffer;
-    buffer.width = bufferWidth;
-    buffer.height = bufferHeight;
+    buffer.width = client->width;
+    buffer.height = client->height;
     buffer.data = new uint32_t[buffer.width * buffer.height];
-    clearBuffer(&buffer, clearColour);
-
-    //create vertex array object
-    GLuint fullscreen_triangle_vao;
-    glGenVertexArrays(1, &fullscreen_triangle_vao);
-    glBindVertexArray(fullscreen_triangle_vao);
-
-    GLuint shaderID = glCreateProgram();
-
-    //create vertex shader
-    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertexShader, 0);
-    glCompileShader(vertex);
-    glAttachShader(shaderID, vertex);
-    glDeleteShader(vertex);
-
-    //create fragment shader
-    GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fragmentShader, 0);
-    glCompileShader(fragment);
-    glAttachShader(shaderID, fragment);
-    glDeleteShader(fragment);
-
-    glLinkProgram(shaderID);
-    glUseProgram(shaderID);
-
-    //create OpenGL texture for buffer
-    GLuint bufferTexture;
-    glGenTextures(1, &bufferTexture);
-    glBindTexture(GL_TEXTURE_2D, bufferTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, buffer.width, buffer.height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer.data);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    GLint location = glGetUniformLocation(shaderID, "buffer");
-    glUniform1i(location, 0);
-
-    glDisable(GL_DEPTH_TEST);
-    glActiveTexture(GL_TEXTURE0);
-
-    //create alien animation
-    SpriteAnimation alienAnimation[3];
-
-    for (size_t i = 0; i < 3; i++){
-        alienAnimation[i].loop = true;
-        alienAnimation[i].frameNum = 2;
-        alienAnimation[i].frameDuration = 10;
-        alienAnimation[i].time = 0;
-
-        alienAnimation[i].frames = new Sprite * [2];
-        alienAnimation[i].frames[0] = &alienSprites[2 * i];
-        alienAnimation[i].frames[1] = &alienSprites[2 * i + 1];
-    }
-
-    //create game struct
-    Game game;
-    game.width = bufferWidth;
-    game.height = bufferHeight;
-    game.bulletNum = 0;
-    game.alienNum = 55;
-    game.aliens = new Alien[game.alienNum];
-
-    game.player.x = 112 - 5;
-    game.player.y = 32;
-
-    game.player.lives = 3;
-
-    for (size_t i = 0; i < 5; i++){
-        for (size_t j = 0; j < 11; j++){
-            Alien& alien = game.aliens[i * 11 + j];
-            alien.type = (5 - i) / 2 + 1;
-
-            const Sprite& sprite = alienSprites[2 * (alien.type - 1)];
-
-            alien.x = 16 * j + 20 + (alienDeathSprite.width - sprite.width) / 2;
-            alien.y = 17 * i + 128;
+
+    uint64_t start = statsNow();
+    while (spectateNext(client, &buffer)){
+    }
+    spectatorReport(*client, (statsNow() - start) * 1e-9);
+    delete[] buffer.data;
+}
+
+//sample consumer: drains the ring until the game closes it, then checks the score events add up
+static bool runConsumer(const char* name){
+    EventRing ring;
+    if (!eventsOpen(&ring, name)) return false;
+    cout << "consuming " << ring.shared.name << endl;
+
+    uint64_t counts[EVENT_TYPE_COUNT] = {};
+    uint64_t scores[4] = {};
+    uint64_t totals[4] = {};
+    uint64_t firstKill = UINT64_MAX;
+    GameEvent batch[1024];
+    uint64_t start = statsNow();
+    for (;;){
+        bool closed = ring.header->closed.load(memory_order_acquire) != 0;
+        size_t count = eventsPoll(&ring, batch, 1024);
+        for (size_t i = 0; i < count; i++){
+            const GameEvent& event = batch[i];
+            if (event.type >= EVENT_TYPE_COUNT) continue;
+            counts[event.type]++;
+            if (event.type == EVENT_SCORE && event.source < 4){
+                scores[event.source] += event.value;
+                totals[event.source] = event.extra;
+            }
+            if (event.type == EVENT_ALIEN_KILLED && firstKill == UINT64_MAX) firstKill = event.tick;
         }
+        //the close flag was read before polling, so nothing can be left behind it
+        if (!count && closed) break;
+        if (!count) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    double seconds = (statsNow() - start) * 1e-9;
+
+    uint64_t received = 0;
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; i++){
+        received += counts[i];
+        cout << "  " << eventTypeNames[i] << ": " << counts[i];
+        uint64_t dropped = ring.header->droppedByType[i].load();
+        if (dropped) cout << " (" << dropped << " dropped)";
+        cout << endl;
+    }
+    cout << received << " events in " << seconds << " s, " << ring.header->dropped.load() << " dropped by the game" << endl;
+    if (firstKill != UINT64_MAX) cout << "first kill at tick " << firstKill << endl;
+    for (size_t i = 0; i < 2; i++){
+        if (!totals[i]) continue;
+        cout << (i ? "rival" : "player") << " score " << totals[i] << ", " << (scores[i] == totals[i] ? "every score event arrived" : "score events are missing") << endl;
     }
 
-    uint8_t* deathCounters = new uint8_t[game.alienNum];
-    for (size_t i = 0; i < game.alienNum; i++){
-        deathCounters[i] = 10;
+    eventsClose(&ring);
+    return true;
+}
+
+//times the scenarios, then either records them as the new baseline or checks them against it
+static bool runScenarios(const GameConfig& config, const Assets& assets){
+    //the replay scenario records a file next to the baseline to play back, and deletes it after
+    string replayPath = string(config.scenarioPath) + ".rep";
+    vector<ScenarioResult> results;
+    if (!scenarioRun(assets, replayPath.c_str(), &results)) return false;
+    scenarioPrint(results, stdout);
+
+    if (config.updateBaseline){
+        bool ok = scenarioWriteBaseline(results, config.scenarioPath);
+        if (ok) cout << "wrote the baseline to " << config.scenarioPath << endl;
+        return ok;
     }
+    return scenarioCheck(results, config.scenarioPath, config.tolerance);
+}
 
-    //render loop
-    while (!glfwWindowShouldClose(window)){
-        auto frameStart = chrono::high_resolution_clock::now();
+int main(int argc, char** argv){
+    GameConfig config;
+    configDefaults(&config);
+    if (!configParse(&config, argc, argv)) return -1;
+
+    //a replay brings its own seed and simulation settings
+    ReplayReader play;
+    if (config.playPath){
+        if (!replayOpen(&play, config.playPath)) return -1;
+        replayConfig(play, &config);
+        //the header is input like the command line and gets the same checks
+        if (!configValidate(&config)){
+            replayClose(&play);
+            return -1;
+        }
+    }
 
-        //process user input
-        glfwSetKeyCallback(window, processInput);
+    Assets assets;
+    uint64_t bakedStart = statsNow();
+    assetsInit(&assets);
+    uint64_t bakedTime = statsNow() - bakedStart;
 
-        //render commands
-        clearBuffer(&buffer, clearColour);
+    if (config.writeAtlasPath){
+        bool ok = atlasWrite(assets, config.writeAtlasPath);
+        if (ok) cout << "wrote the built-in sprites to " << config.writeAtlasPath << endl;
+        assetsFree(&assets);
+        return ok ? 0 : -1;
+    }
+    if (config.atlasPath){
+        uint64_t atlasStart = statsNow();
+        if (!atlasLoad(&assets, config.atlasPath)){
+            assetsFree(&assets);
+            return -1;
+        }
+        const AtlasHeader& header = *(const AtlasHeader*)assets.atlas.data;
+        cout << "atlas " << config.atlasPath << ": " << header.rowNum << " rows, " << assets.atlas.size / 1024.0 << " KB mapped and checked in "
+             << (statsNow() - atlasStart) * 1e-3 << " us, built-in sprites set up in " << bakedTime * 1e-3 << " us" << endl;
+    }
 
-        //draw text and score
-        drawText(&buffer, textSheet, "SCORE", 4, game.height - textSheet.height - 7, rgbToUint32(0, 255, 0));
-        drawNumber(&buffer, numberSheet, score, 4 + 2 * numberSheet.width, game.height - 2 * numberSheet.height - 12,rgbToUint32(0, 255, 0));
-        drawText(&buffer, textSheet, "CREDIT 00", 164, 7, rgbToUint32(0, 255, 0));
+    if (config.batchNum){
+        runBatch(config, assets);
+        assetsFree(&assets);
+        return 0;
+    }
 
-        for (size_t i = 0; i < game.width; i++){
-            buffer.data[game.width * 16 + i] = rgbToUint32(0, 255, 0);
+    if (config.verifyPath){
+        size_t threads = config.threads ? config.threads : thread::hardware_concurrency();
+        VerifySummary summary;
+        bool ok = verifyReplays(config.verifyPath, threads, assets, &summary);
+        if (ok){
+            cout << summary.passNum << " of " << summary.replayNum << " replays verified in " << summary.seconds << " s on " << threads << " threads: "
+                 << summary.replayNum / summary.seconds << " replays/s, " << summary.tickNum / summary.seconds << " ticks/s" << endl;
         }
+        assetsFree(&assets);
+        return ok && summary.passNum == summary.replayNum ? 0 : -1;
+    }
 
-        //draw aliens
-        for (size_t i = 0; i < game.alienNum; i++){
-            if (!deathCounters[i]) continue;
+    if (config.consumeName){
+        bool ok = runConsumer(config.consumeName);
+        assetsFree(&assets);
+        return ok ? 0 : -1;
+    }
 
-            const Alien& alien = game.aliens[i];
+    if (config.scenarioPath){
+        bool ok = runScenarios(config, assets);
+        assetsFree(&assets);
+        return ok ? 0 : -1;
+    }
 
-            if (alien.type == ALIEN_DEAD) {
-                drawSprite(&buffer, alienDeathSprite, alien.x, alien.y, rgbToUint32(0, 255, 0));
-            }
+    if (config.netMode == NET_MODE_BENCH){
+        bool ok = runVersusBench(config, assets);
+        assetsFree(&assets);
+        return ok ? 0 : -1;
+    }
 
-            else {
-                const SpriteAnimation& animation = alienAnimation[alien.type - 1];
-                size_t currentFrame = animation.time / animation.frameDuration;
-                const Sprite& sprite = *animation.frames[currentFrame];
-                drawSprite(&buffer, sprite, alien.x, alien.y, rgbToUint32(0, 255, 0));
-            }            
-        }
+    if (config.bridgeMode == BRIDGE_MODE_AGENT){
+        bool ok = runBridgeAgent(config);
+        assetsFree(&assets);
+        return ok ? 0 : -1;
+    }
 
-        //draw player
-        drawSprite(&buffer, playerSprite, game.player.x, game.player.y, rgbToUint32(0, 255, 0));
+    //a spectator shows frames from the stream instead of simulating
+    SpectateClient spectator;
+    bool spectating = config.spectateName != nullptr;
+    if (spectating && !spectateConnect(&spectator, config.spectateName)){
+        assetsFree(&assets);
+        return -1;
+    }
+    if (spectating && config.headless){
+        runSpectator(&spectator);
+        spectateDisconnect(&spectator);
+        assetsFree(&assets);
+        return 0;
+    }
 
-        //draw bullets
-        for (size_t i = 0; i < game.bulletNum; i++)
-        {
-            const Bullet& bullet = game.bullets[i];
-            const Sprite& sprite = bulletSprite;
-            drawSprite(&buffer, sprite, bullet.x, bullet.y, rgbToUint32(0, 255, 0));
+    //create game struct, a loaded state keeps its own shape
+    Game* game;
+    if (config.loadPath){
+        uint64_t loadStart = statsNow();
+        game = gameLoad(config.loadPath);
+        if (!game){
+            assetsFree(&assets);
+            return -1;
         }
+        cout << "restored " << gameStateSize(*game) << " bytes at tick " << game->tick << " in " << (statsNow() - loadStart) * 1e-3 << " us" << endl;
+    }
+    else {
+        game = gameCreate(config, assets);
+    }
 
-        //update animations
-        for (size_t i = 0; i < 3; i++) {
-            alienAnimation[i].time++;
-            if (alienAnimation[i].time == alienAnimation[i].frameNum * alienAnimation[i].frameDuration) {
-                alienAnimation[i].time = 0;
+    //create buffer
+    Buffer buffer;
+    buffer.width = spectating ? spectator.width : game->width;
+    buffer.height = spectating ? spectator.height : game->height;
+    buffer.data = new uint32_t[buffer.width * buffer.height];
+    clearBuffer(&buffer, rgbToUint32(0, 0, 0));
+
+    if (config.stats){
+        cout << game->alienNum << " aliens, " << game->botNum << " bots, " << buffer.width << "x" << buffer.height << ", seed " << config.seed << endl;
+    }
+
+    //checksums live next to the replay in FILE.sum
+    Session session = {};
+    ReplayWriter record;
+    ChecksumWriter checksums;
+    ChecksumReader expected;
+    session.frames = config.hashFrames;
+    if (config.playPath){
+        session.play = &play;
+        string path = string(config.playPath) + ".sum";
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file){
+            fclose(file);
+            if (checksumOpen(&expected, path.c_str())){
+                session.expected = &expected;
+                session.frames = expected.header->frames != 0;
             }
         }
+    }
+    if (config.recordPath && replayCreate(&record, config.recordPath, config)){
+        session.record = &record;
+        string path = string(config.recordPath) + ".sum";
+        if (checksumCreate(&checksums, path.c_str(), session.frames)) session.checksums = &checksums;
+    }
 
-        for (size_t i = 0; i < game.alienNum; i++) {
-            const Alien& alien = game.aliens[i];
-            if (alien.type == ALIEN_DEAD && deathCounters[i]) {
-                deathCounters[i]--;
-            }
+    //a windowed versus side plays from the keyboard, headless ones are run by runVersus
+    NetPeer peer;
+    bool networked = config.versus && !config.headless;
+    if (networked && !netOpen(&peer, config, game, assets, config.netMode == NET_MODE_JOIN)){
+        delete[] buffer.data;
+        gameDestroy(game);
+        assetsFree(&assets);
+        return -1;
+    }
+
+    EventRing events;
+    bool publishing = config.eventsName && eventsCreate(&events, config.eventsName, EVENT_RING_CAPACITY);
+    if (publishing) eventsAttach(&events);
+
+    SpectateServer broadcast;
+    if (config.broadcastName){
+        if (spectateServerStart(&broadcast, config.broadcastName, buffer.width, buffer.height)) session.broadcast = &broadcast;
+        else cout << "continuing without spectators" << endl;
+    }
+
+    RewindBuffer rewind;
+    if (config.rewindSeconds){
+        rewindInit(&rewind, *game, config.rewindSeconds, 60);
+        rewindPush(&rewind, *game, GameInput{0, false});
+        session.rewind = &rewind;
+    }
+
+    //attached ahead of the frame loop, whose heap guard would stop the ring's allocation
+    if (config.tracePath) traceAttach(TRACE_EVENT_CAPACITY, "main");
+
+    //false once a mode that checks something finds a problem, the exit code reports it
+    bool ok = true;
+    statsReset();
+    uint64_t start = statsNow();
+
+    if (config.bridgeMode == BRIDGE_MODE_HOST || config.bridgeMode == BRIDGE_MODE_BENCH){
+        ok = config.bridgeMode == BRIDGE_MODE_HOST ? runBridgeHost(config, assets, game) : runBridgeBench(config, assets, game);
+        if (!ok){
+            delete[] buffer.data;
+            gameDestroy(game);
+            assetsFree(&assets);
+            return -1;
+        }
+    }
+    else if (config.check){
+        ok = runLockstep(config, assets, &buffer, &session);
+    }
+    else if (config.versus && config.headless){
+        uint64_t state;
+        ok = runVersus(config, game, assets, config.netMode == NET_MODE_JOIN, &state);
+    }
+    else if (config.headless){
+        runHeadless(game, assets, &buffer, config, &session);
+    }
+    else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        //create window, large logical resolutions are scaled down to fit on screen
+        size_t windowWidth = buffer.width;
+        size_t windowHeight = buffer.height;
+        size_t largest = windowWidth > windowHeight ? windowWidth : windowHeight;
+        if (largest > maxWindowSize){
+            windowWidth = windowWidth * maxWindowSize / largest;
+            windowHeight = windowHeight * maxWindowSize / largest;
+        }
+
+        GLFWwindow* window = glfwCreateWindow((int)windowWidth, (int)windowHeight, "space invaders", NULL, NULL);
+        if (window == NULL){
+            cout << "Failed to create GLFW window" << endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        glfwMakeContextCurrent(window);
+
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
+            cout << "Failed to initialize GLAD" << endl;
+            return -1;
         }
 
-        //update bullets
-        for (size_t i = 0; i < game.bulletNum; i++){
-            game.bullets[i].y += game.bullets[i].dir;
-            if (game.bullets[i].y >= game.height || game.bullets[i].y < bulletSprite.height){
-                game.bullets[i] = game.bullets[game.bulletNum - 1];
-                game.bulletNum--;
-                continue;
+        glViewport(0, 0, (GLsizei)windowWidth, (GLsizei)windowHeight);
+
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
+        //turn on vsync
+        glfwSwapInterval(1);
+
+        //create vertex array object
+        GLuint fullscreen_triangle_vao;
+        glGenVertexArrays(1, &fullscreen_triangle_vao);
+        glBindVertexArray(fullscreen_triangle_vao);
+
+        GLuint shaderID = glCreateProgram();
+
+        //create vertex shader
+        GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vertexShader, 0);
+        glCompileShader(vertex);
+        glAttachShader(shaderID, vertex);
+        glDeleteShader(vertex);
+
+        //create fragment shader
+        GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fragmentShader, 0);
+        glCompileShader(fragment);
+        glAttachShader(shaderID, fragment);
+        glDeleteShader(fragment);
+
+        glLinkProgram(shaderID);
+        glUseProgram(shaderID);
+
+        //create OpenGL texture for buffer
+        GLuint bufferTexture;
+        glGenTextures(1, &bufferTexture);
+        glBindTexture(GL_TEXTURE_2D, bufferTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, buffer.width, buffer.height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer.data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        GLint location = glGetUniformLocation(shaderID, "buffer");
+        glUniform1i(location, 0);
+
+        glDisable(GL_DEPTH_TEST);
+        glActiveTexture(GL_TEXTURE0);
+
+        glfwSetKeyCallback(window, processInput);
+
+        AtlasWatch watch;
+        bool watching = config.atlasPath && atlasWatch(&watch, config.atlasPath);
+
+        //render loop
+        while (!glfwWindowShouldClose(window) && (!config.ticks || game->tick < config.ticks)){
+            //process user input
+            GameInput input;
+            {
+                PHASE_SCOPE(PHASE_INPUT);
+                glfwPollEvents();
+                input.dir = inputDir;
+                input.fire = fire;
+                fire = false;
             }
+            if (!sessionInput(&session, &input)) break;
 
-            //check if alien hit
-            for (size_t j = 0; j < game.alienNum; j++){
-                const Alien& alien = game.aliens[j];
-                if (alien.type == ALIEN_DEAD) continue;
-
-                const SpriteAnimation& animation = alienAnimation[alien.type - 1];
-                size_t currentFrame = animation.time / animation.frameDuration;
-                const Sprite& alienSprite = *animation.frames[currentFrame];
-                bool overlap = spriteOverlap(bulletSprite, game.bullets[i].x, game.bullets[i].y, alienSprite, alien.x, alien.y);
-                
-                if (overlap){
-                    game.aliens[j].type = ALIEN_DEAD;
-                    game.aliens[j].x -= (alienDeathSprite.width - alienSprite.width) / 2;
-                    game.bullets[i] = game.bullets[game.bulletNum - 1];
-                    game.bulletNum--;
-                    score += 10 * (4 - game.aliens[j].type);
-                    continue;
-                }
+            //nothing is drawing between frames, so the old atlas can go
+            if (watching && atlasChanged(&watch) && atlasReload(&assets, config.atlasPath)){
+                cout << "reloaded " << config.atlasPath << endl;
             }
-        }
 
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, buffer.width, buffer.height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer.data);
-        
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+            if (spectating){
+                if (!spectateNext(&spectator, &buffer)) break;
+            }
+            //step back a tick instead of forward, the discarded future is replaced by new input
+            else if (rewinding && session.rewind && !session.play){
+                if (game->tick > rewind.oldest){
+                    rewindRestore(&rewind, game, game->tick - 1);
+                    rewindDiscard(&rewind, game->tick);
+                }
+                gameDraw(&buffer, *game, assets);
+            }
+            else if (networked){
+                gameDraw(&buffer, *game, assets);
+                netFrame(&peer, input);
+            }
+            else {
+                //render commands
+                {
+                    HEAP_GUARD_SCOPE("the frame loop");
+                    gameDraw(&buffer, *game, assets);
+                    gameStep(game, assets, input);
+                }
+                sessionTick(&session, input, *game, buffer);
+            }
 
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+            {
+                PHASE_SCOPE(PHASE_UPLOAD);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, buffer.width, buffer.height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer.data);
 
-        //check and call events, swap buffers
-        glfwSwapBuffers(window);
+                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
 
-        //update player movement
-        int playerDir = 2 * inputDir;
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
 
-        if (playerDir != 0){
-            if (game.player.x + playerSprite.width + playerDir >= game.width) {
-                game.player.x = game.width - playerSprite.width;
+            //check and call events, swap buffers
+            {
+                PHASE_SCOPE(PHASE_SWAP);
+                glfwSwapBuffers(window);
             }
-            else if ((int)game.player.x + playerDir <= 0) {
-                game.player.x = 0;
-                playerDir *= -1;
+
+            {
+                PHASE_SCOPE(PHASE_SLEEP);
+                this_thread::sleep_for(chrono::milliseconds(frameDelay));
             }
-            else game.player.x += playerDir;
-        }
 
-        if (fire && game.bulletNum < MAX_BULLETS){
-            game.bullets[game.bulletNum].x = game.player.x + playerSprite.width / 2;
-            game.bullets[game.bulletNum].y = game.player.y + playerSprite.height;
-            game.bullets[game.bulletNum].dir = 2;
-            game.bulletNum++;
+            statsEndFrame();
         }
 
-        fire = false;
+        if (watching) atlasUnwatch(&watch);
+        glfwTerminate();
+    }
+
+    //written before the rewind report re-simulates ticks into the ring
+    if (config.tracePath){
+        traceWrite(config.tracePath);
+        traceDetach();
+    }
 
-        glfwPollEvents();
+    if (config.playPath && !config.check){
+        double seconds = (statsNow() - start) * 1e-9;
+        cout << "played " << game->tick << " of " << play.header->tickNum << " ticks in " << seconds << " s, " << game->tick / seconds / 60 << "x real time, score " << game->score << endl;
+    }
+    if (session.expected){
+        if (expected.diverged) cout << "first divergence at tick " << expected.divergedTick << " of " << expected.header->tickNum << endl;
+        else cout << "checksums match for " << expected.header->tickNum << " recorded ticks" << endl;
+        checksumClose(&expected);
+    }
+    if (config.playPath) replayClose(&play);
+    if (session.record) replayFinish(&record, *game);
+    if (session.checksums) checksumFinish(&checksums);
+
+    if (publishing){
+        cout << "events: " << events.head << " published, " << events.header->dropped.load() << " dropped, peak fill at most "
+             << events.highWater << " of " << events.header->capacity << endl;
+        eventsClose(&events);
+    }
+    if (spectating){
+        spectatorReport(spectator, (statsNow() - start) * 1e-9);
+        spectateDisconnect(&spectator);
+    }
+    if (session.broadcast){
+        spectateServerStop(&broadcast);
+        broadcastReport(broadcast);
+    }
 
-        this_thread::sleep_for(chrono::milliseconds(frameDelay));
+    if (networked){
+        netFinish(&peer, config);
+        ChecksumRecord record;
+        checksumGame(*game, nullptr, &record);
+        netReport(peer, record.state);
+        netPeerFree(&peer);
     }
 
-    for (size_t i = 0; i < 6; i++){
-        delete[] alienSprites[i].data;
+    if (session.rewind){
+        if (config.headless) rewindReport(&rewind, game, assets);
+        rewindFree(&rewind);
     }
 
-    delete[] alienDeathSprite.data;
+    if (config.savePath && gameSave(*game, config.savePath)){
+        cout << "saved " << gameStateSize(*game) << " bytes at tick " << game->tick << " to " << config.savePath << endl;
+    }
 
-    for (size_t i = 0; i < 3; i++){
-        delete[] alienAnimation[i].frames;
+    if (config.stats){
+        cout << "score " << game->score << " after " << game->tick << " ticks" << endl;
+        statsPrint(stdout);
     }
 
     delete[] buffer.data;
-    delete[] game.aliens;
-    delete[] deathCounters;
-
-    glfwTerminate();
+    gameDestroy(game);
+    assetsFree(&assets);
 
-    return 0;
+    return ok ? 0 : -1;
 }
-
@@ -0,0 +1,74 @@
+#include "mapfile.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool mapFile(MappedFile* file, const char* path){
+    memset(file, 0, sizeof(MappedFile));
+#ifndef _WIN32
+    file->fd = -1;
+#endif
+
+#ifdef _WIN32
+    file->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file->file == INVALID_HANDLE_VALUE){
+        file->file = nullptr;
+        cout << "Failed to open " << path << endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx((HANDLE)file->file, &size);
+    file->size = (size_t)size.QuadPart;
+    if (!file->size) return true;
+
+    file->mapping = CreateFileMappingA((HANDLE)file->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    file->data = file->mapping ? (const uint8_t*)MapViewOfFile((HANDLE)file->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0){
+        cout << "Failed to open " << path << endl;
+        return false;
+    }
+    struct stat info;
+    fstat(file->fd, &info);
+    file->size = (size_t)info.st_size;
+    if (!file->size) return true;
+
+    void* data = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    file->data = data != MAP_FAILED ? (const uint8_t*)data : nullptr;
+#endif
+
+    if (!file->data){
+        cout << "Failed to map " << path << endl;
+        unmapFile(file);
+        return false;
+    }
+    return true;
+}
+
+void unmapFile(MappedFile* file){
+#ifdef _WIN32
+    if (file->data) UnmapViewOfFile(file->data);
+    if (file->mapping) CloseHandle((HANDLE)file->mapping);
+    if (file->file) CloseHandle((HANDLE)file->file);
+#else
+    if (file->data) munmap((void*)file->data, file->size);
+    if (file->fd >= 0) close(file->fd);
+#endif
+    memset(file, 0, sizeof(MappedFile));
+#ifndef _WIN32
+    file->fd = -1;
+#endif
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//read-only memory mapping of a whole file, pages are loaded on first touch
+struct MappedFile{
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int fd;
+#endif
+};
+
+//prints and returns false if the file can't be opened, an empty file maps to data == nullptr
+bool mapFile(MappedFile* file, const char* path);
+void unmapFile(MappedFile* file);
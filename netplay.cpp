@@ -0,0 +1,288 @@
+#include "netplay.h"
+#include "heap.h"
+#include "snapshot.h"
+#include "stats.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const size_t packetHeaderSize = offsetof(NetPacket, inputs);
+
+static sockaddr_in loopbackAddress(uint16_t port){
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+static void closeSocket(intptr_t socket){
+#ifdef _WIN32
+    closesocket((SOCKET)socket);
+#else
+    close((int)socket);
+#endif
+}
+
+static bool linkOpen(NetLink* link, uint16_t localPort, uint16_t remotePort){
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0){
+        cout << "Failed to start winsock" << endl;
+        return false;
+    }
+    SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    bool ok = handle != INVALID_SOCKET;
+    u_long nonBlocking = 1;
+    if (ok) ok = ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, 0);
+    bool ok = handle >= 0;
+    if (ok) ok = fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+    sockaddr_in address = loopbackAddress(localPort);
+    if (ok) ok = bind(handle, (const sockaddr*)&address, sizeof(address)) == 0;
+    if (!ok){
+        cout << "Failed to bind UDP port " << localPort << endl;
+        closeSocket((intptr_t)handle);
+        return false;
+    }
+
+    link->socket = (intptr_t)handle;
+    link->remotePort = remotePort;
+    return true;
+}
+
+static void linkClose(NetLink* link){
+    closeSocket(link->socket);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+//sends what is due, packets are held in order so a fixed delay never reorders them
+static void linkFlush(NetLink* link){
+    uint64_t now = statsNow();
+    sockaddr_in address = loopbackAddress(link->remotePort);
+    while (!link->queue.empty() && link->queue.front().due <= now){
+        const NetDelayed& delayed = link->queue.front();
+        sendto(link->socket, (const char*)&delayed.packet, delayed.size, 0, (const sockaddr*)&address, sizeof(address));
+        link->queue.pop_front();
+    }
+}
+
+static void linkSend(NetLink* link, const NetPacket& packet, uint32_t size){
+    link->sent++;
+    if (link->lossPercent && rngRange(&link->rng, 100) < link->lossPercent){
+        link->dropped++;
+        return;
+    }
+    NetDelayed delayed;
+    delayed.due = statsNow() + (uint64_t)link->delayMs * 1000000;
+    delayed.size = size;
+    memcpy(&delayed.packet, &packet, size);
+    link->queue.push_back(delayed);
+    linkFlush(link);
+}
+
+static bool linkReceive(NetLink* link, NetPacket* packet){
+    int size = (int)recv(link->socket, (char*)packet, sizeof(NetPacket), 0);
+    if (size < (int)packetHeaderSize || packet->magic != NET_MAGIC || packet->count > NET_MAX_SEND) return false;
+    if ((size_t)size < packetHeaderSize + packet->count) return false;
+    link->received++;
+    return true;
+}
+
+bool netPeerInit(NetPeer* peer, Game* game, const Assets& assets, uint32_t self, uint16_t localPort, uint16_t remotePort, size_t window,
+                 uint32_t delayMs, uint32_t lossPercent){
+    peer->game = game;
+    peer->assets = &assets;
+    peer->self = self;
+    peer->window = window < 1 ? 1 : window > NET_MAX_WINDOW ? NET_MAX_WINDOW : window;
+    peer->seed = game->rng.state;
+    memset(peer->local, 0, sizeof(peer->local));
+    memset(peer->remote, 0, sizeof(peer->remote));
+    memset(peer->predicted, 0, sizeof(peer->predicted));
+    peer->remoteNext = game->tick;
+    peer->peerAck = game->tick;
+    peer->rollbackFrom = UINT64_MAX;
+    peer->stateSize = gameStateSize(*game);
+    peer->snapshots = new uint8_t[(peer->window + 1) * peer->stateSize];
+    memset(&peer->stats, 0, sizeof(NetStats));
+    peer->pending.clear();
+    peer->pending.reserve((peer->window + 1) * 64);
+
+    NetLink& link = peer->link;
+    link.delayMs = delayMs;
+    link.lossPercent = lossPercent;
+    rngSeed(&link.rng, peer->seed ^ (self + 1));
+    link.sent = link.dropped = link.received = link.foreign = 0;
+    if (!linkOpen(&link, localPort, remotePort)){
+        delete[] peer->snapshots;
+        return false;
+    }
+    return true;
+}
+
+void netPeerFree(NetPeer* peer){
+    linkClose(&peer->link);
+    delete[] peer->snapshots;
+    vector<GameEvent>().swap(peer->pending);
+}
+
+static uint8_t* netSnapshot(NetPeer* peer, uint64_t tick){
+    return peer->snapshots + tick % (peer->window + 1) * peer->stateSize;
+}
+
+//remote input for tick, confirmed if it has arrived and otherwise the last confirmed one repeated
+static uint8_t netRemoteInput(NetPeer* peer, uint64_t tick){
+    if (tick < peer->remoteNext) return peer->remote[tick % NET_HISTORY];
+    uint8_t guess = peer->remoteNext ? peer->remote[(peer->remoteNext - 1) % NET_HISTORY] : 0;
+    peer->predicted[tick % NET_HISTORY] = guess;
+    return guess;
+}
+
+static void netStep(NetPeer* peer){
+    uint64_t tick = peer->game->tick;
+    gameSnapshot(*peer->game, netSnapshot(peer, tick));
+
+    GameInput local = gameInputUnpack(peer->local[tick % NET_HISTORY]);
+    GameInput remote = gameInputUnpack(netRemoteInput(peer, tick));
+    bool publishing = eventsAttached() != nullptr;
+    if (publishing) eventsStage(&peer->pending);
+    if (peer->self) gameStepVersus(peer->game, *peer->assets, remote, local);
+    else gameStepVersus(peer->game, *peer->assets, local, remote);
+    if (publishing) eventsStage(nullptr);
+}
+
+//publishes the staged events of ticks whose remote input has arrived. everything before
+//remoteNext was confirmed in order and any wrong prediction has been rolled back, so
+//those ticks will never be simulated again
+static void netPublish(NetPeer* peer){
+    EventRing* ring = eventsAttached();
+    vector<GameEvent>& pending = peer->pending;
+    size_t num = 0;
+    while (num < pending.size() && pending[num].tick < peer->remoteNext){
+        if (ring) eventPush(ring, pending[num]);
+        num++;
+    }
+    pending.erase(pending.begin(), pending.begin() + num);
+}
+
+static void netReceive(NetPeer* peer){
+    NetPacket packet;
+    while (linkReceive(&peer->link, &packet)){
+        if (packet.seed != peer->seed){
+            //only the first is reported, the remote repeats itself every frame
+            if (!peer->link.foreign++){
+                cout << "ignoring packets from a game started with another --seed or config" << endl;
+            }
+            continue;
+        }
+        if (packet.ack > peer->peerAck) peer->peerAck = packet.ack;
+
+        for (uint32_t i = 0; i < packet.count; i++){
+            uint64_t tick = packet.first + i;
+            if (tick < peer->remoteNext) continue;
+            if (tick > peer->remoteNext) break;
+
+            uint8_t input = packet.inputs[i];
+            peer->remote[tick % NET_HISTORY] = input;
+            if (tick < peer->game->tick && peer->predicted[tick % NET_HISTORY] != input && tick < peer->rollbackFrom){
+                peer->rollbackFrom = tick;
+            }
+            peer->remoteNext++;
+        }
+    }
+}
+
+//re-simulates from the earliest wrong prediction, refreshing the snapshots on the way
+static void netRollback(NetPeer* peer){
+    if (peer->rollbackFrom == UINT64_MAX) return;
+
+    uint64_t start = statsNow();
+    uint64_t now = peer->game->tick;
+    uint64_t depth = now - peer->rollbackFrom;
+    //the staged events from the wrong prediction on are replaced by the re-simulation's
+    vector<GameEvent>& pending = peer->pending;
+    size_t keep = 0;
+    while (keep < pending.size() && pending[keep].tick < peer->rollbackFrom) keep++;
+    pending.resize(keep);
+
+    gameRestore(peer->game, netSnapshot(peer, peer->rollbackFrom), peer->stateSize);
+    while (peer->game->tick < now){
+        netStep(peer);
+    }
+    peer->rollbackFrom = UINT64_MAX;
+
+    uint64_t elapsed = statsNow() - start;
+    NetStats& stats = peer->stats;
+    stats.rollbacks++;
+    stats.resimTicks += depth;
+    stats.resimNs += elapsed;
+    if (depth > stats.maxDepth) stats.maxDepth = depth;
+    if (elapsed > stats.maxResimNs) stats.maxResimNs = elapsed;
+}
+
+static void netSend(NetPeer* peer){
+    uint64_t end = peer->game->tick;
+    uint64_t first = peer->peerAck;
+    //inputs this old were overwritten in the ring, the remote can't be that far behind in practice
+    if (end > NET_MAX_SEND && first < end - NET_MAX_SEND) first = end - NET_MAX_SEND;
+
+    NetPacket packet;
+    packet.magic = NET_MAGIC;
+    packet.seed = peer->seed;
+    packet.first = first;
+    packet.ack = peer->remoteNext;
+    packet.count = (uint32_t)(end > first ? end - first : 0);
+    for (uint32_t i = 0; i < packet.count; i++){
+        packet.inputs[i] = peer->local[(first + i) % NET_HISTORY];
+    }
+    linkSend(&peer->link, packet, (uint32_t)(packetHeaderSize + packet.count));
+}
+
+bool netFrame(NetPeer* peer, const GameInput& input){
+    HEAP_TAG("netplay");
+    linkFlush(&peer->link);
+    netReceive(peer);
+    netRollback(peer);
+
+    bool advance = peer->game->tick < peer->remoteNext + peer->window;
+    if (advance){
+        peer->local[peer->game->tick % NET_HISTORY] = gameInputPack(input);
+        netStep(peer);
+        peer->stats.frames++;
+    }
+    else {
+        peer->stats.stalls++;
+    }
+    netPublish(peer);
+    netSend(peer);
+    return advance;
+}
+
+bool netSettle(NetPeer* peer){
+    linkFlush(&peer->link);
+    netReceive(peer);
+    netRollback(peer);
+    netPublish(peer);
+    netSend(peer);
+    return peer->remoteNext >= peer->game->tick && peer->peerAck >= peer->game->tick;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "game.h"
+#include "events.h"
+
+#define NET_MAGIC 0x4E504953u //"SINP"
+#define NET_HISTORY 256   //ticks of input kept on each side, a power of two
+#define NET_MAX_WINDOW 64 //largest rollback window
+#define NET_MAX_SEND 128  //most inputs in one packet
+
+//every packet repeats all of the sender's inputs the receiver hasn't acknowledged,
+//so a lost packet is covered by the next one and nothing is ever retransmitted
+struct NetPacket{
+    uint32_t magic;
+    uint32_t count;
+    uint64_t seed;
+    uint64_t first; //tick of inputs[0]
+    uint64_t ack;   //the sender has every input of ours before this tick
+    uint8_t inputs[NET_MAX_SEND];
+};
+
+struct NetDelayed{
+    uint64_t due;
+    uint32_t size;
+    NetPacket packet;
+};
+
+//UDP on the loopback interface. outgoing packets can be dropped or held back to
+//test against a bad network without leaving the machine.
+struct NetLink{
+    intptr_t socket;
+    uint16_t remotePort;
+    uint32_t delayMs;
+    uint32_t lossPercent;
+    Rng rng;
+    std::deque<NetDelayed> queue;
+    uint64_t sent, dropped, received;
+    uint64_t foreign; //packets from a game with another seed, ignored
+};
+
+struct NetStats{
+    uint64_t frames;
+    uint64_t stalls;     //frames that waited because the remote was too far behind
+    uint64_t rollbacks;
+    uint64_t resimTicks;
+    uint64_t maxDepth;
+    uint64_t resimNs;
+    uint64_t maxResimNs;
+};
+
+//one side of a rollback versus game. remote input that hasn't arrived is predicted
+//to repeat the last one that has, and every simulated tick keeps a snapshot. when
+//the real input disagrees with a prediction, the game is restored to that tick and
+//re-simulated up to the present within the same frame. events are published only once
+//their tick is final.
+struct NetPeer{
+    Game* game;
+    const Assets* assets;
+    NetLink link;
+    uint32_t self;   //0 plays player, 1 plays rival
+    size_t window;   //most ticks remote input can be predicted ahead
+    uint64_t seed;
+    uint8_t local[NET_HISTORY];
+    uint8_t remote[NET_HISTORY];
+    uint8_t predicted[NET_HISTORY];
+    uint64_t remoteNext; //first tick whose remote input hasn't arrived
+    uint64_t peerAck;    //first tick of ours the remote hasn't acknowledged
+    uint64_t rollbackFrom;
+    size_t stateSize;
+    uint8_t* snapshots; //window + 1 states by tick
+    std::vector<GameEvent> pending; //events of ticks that may still be rolled back, by tick
+    NetStats stats;
+};
+
+//binds 127.0.0.1:localPort and talks to 127.0.0.1:remotePort. both sides must
+//start from the same seed and config
+bool netPeerInit(NetPeer* peer, Game* game, const Assets& assets, uint32_t self, uint16_t localPort, uint16_t remotePort, size_t window,
+                 uint32_t delayMs, uint32_t lossPercent);
+void netPeerFree(NetPeer* peer);
+
+//receives input, rolls back if a prediction was wrong, then steps one tick with
+//input as the local player's. returns false on a stall, when the remote is a whole
+//window behind and the tick has to wait
+bool netFrame(NetPeer* peer, const GameInput& input);
+
+//receives, corrects and resends without stepping. true once every input before
+//game->tick is confirmed on both sides, so the state is final and the remote has it
+bool netSettle(NetPeer* peer);
@@ -0,0 +1,63 @@
+#include "render.h"
+#include "simd.h"
+
+void clearBuffer(Buffer* buffer, uint32_t colour){
+    for (size_t i = 0; i < buffer->width * buffer->height; i++)    {
+        buffer->data[i] = colour;
+    }
+}
+
+void drawSprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t colour){
+    for (size_t j = 0; j < sprite.height; j++){
+        if (y + j >= buffer->height) continue;
+
+        uint32_t* line = buffer->data + (y + j) * buffer->width;
+        uint32_t mask = sprite.rows[j];
+        while (mask){
+            size_t i = lowestBit(mask);
+            mask &= mask - 1;
+            if (x + i < buffer->width) line[x + i] = colour;
+        }
+    }
+}
+
+void drawText(Buffer* buffer, const Sprite& textSheet, const char* text, size_t x, size_t y, uint32_t colour){
+    size_t xp = x;
+    Sprite sprite = textSheet;
+    for (const char* charp = text; *charp != '\0'; ++charp){
+        char character = *charp - 32;
+        if (character < 0 || character >= 65) continue;
+
+        sprite.rows = textSheet.rows + character * textSheet.height;
+        drawSprite(buffer, sprite, xp, y, colour);
+        xp += sprite.width + 1;
+    }
+}
+
+void drawNumber(Buffer* buffer, const Sprite& numberSheet, size_t number, size_t x, size_t y, uint32_t colour){
+    uint8_t digits[64];
+    size_t numDigits = 0;
+
+    size_t currentNum = number;
+    do{
+        digits[numDigits++] = currentNum % 10;
+        currentNum = currentNum / 10;
+    } while (currentNum > 0);
+
+    size_t xp = x;
+    Sprite sprite = numberSheet;
+    for (size_t i = 0; i < numDigits; i++){
+        uint8_t digit = digits[numDigits - i - 1];
+        sprite.rows = numberSheet.rows + digit * numberSheet.height;
+        drawSprite(buffer, sprite, xp, y, colour);
+        xp += sprite.width + 1;
+    }
+}
+
+uint32_t rgbToUint32(uint8_t r, uint8_t g, uint8_t b){
+    return (r << 24) | (g << 16) | (b << 8) | 255;
+}
+
+bool spriteOverlap(const Sprite& sprite1, size_t x1, size_t y1, const Sprite& sprite2, size_t x2, size_t y2){
+    return (x1 < x2 + sprite2.width && x1 + sprite1.width > x2 && y1 < y2 + sprite2.height && y1 + sprite1.height > y2);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct Buffer{
+    size_t width, height;
+    uint32_t* data;
+};
+
+//one bit mask per row, bottom row first, bit i is column i
+struct Sprite{
+    size_t width, height;
+    const uint32_t* rows;
+};
+
+void clearBuffer(Buffer* buffer, uint32_t colour);
+void drawSprite(Buffer* buffer, const Sprite& sprite, size_t x, size_t y, uint32_t colour);
+void drawText(Buffer* buffer, const Sprite& textSheet, const char* text, size_t x, size_t y, uint32_t colour);
+void drawNumber(Buffer* buffer, const Sprite& numberSheet, size_t number, size_t x, size_t y, uint32_t colour);
+uint32_t rgbToUint32(uint8_t r, uint8_t g, uint8_t b);
+bool spriteOverlap(const Sprite& sprite1, size_t x1, size_t y1, const Sprite& sprite2, size_t x2, size_t y2);
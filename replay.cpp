@@ -0,0 +1,152 @@
+#include "replay.h"
+#include "checksum.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static_assert(sizeof(ReplayHeader) == 80, "replay header layout is part of the file format");
+
+static void replayFlushRun(ReplayWriter* writer){
+    if (!writer->count) return;
+
+    uint8_t run[11];
+    size_t size = 0;
+    run[size++] = writer->input;
+    uint64_t count = writer->count;
+    do {
+        uint8_t byte = count & 0x7F;
+        count >>= 7;
+        run[size++] = count ? byte | 0x80 : byte;
+    } while (count);
+
+    fwrite(run, 1, size, writer->file);
+    writer->header.runNum++;
+    writer->count = 0;
+}
+
+bool replayCreate(ReplayWriter* writer, const char* path, const GameConfig& config){
+    memset(writer, 0, sizeof(ReplayWriter));
+    writer->file = fopen(path, "wb");
+    if (!writer->file){
+        cout << "Failed to create replay " << path << endl;
+        return false;
+    }
+
+    ReplayHeader& header = writer->header;
+    header.magic = REPLAY_MAGIC;
+    header.version = REPLAY_VERSION;
+    header.seed = config.seed;
+    header.width = (uint32_t)config.width;
+    header.height = (uint32_t)config.height;
+    header.rows = (uint32_t)config.rows;
+    header.cols = (uint32_t)config.cols;
+    header.bulletCapacity = (uint32_t)config.bulletCapacity;
+    header.botNum = (uint32_t)config.botNum;
+    header.fireInterval = config.fireInterval;
+
+    //placeholder, the counts are patched in by replayFinish
+    fwrite(&header, sizeof(header), 1, writer->file);
+    return true;
+}
+
+void replayWrite(ReplayWriter* writer, const GameInput& input){
+    uint8_t bits = gameInputPack(input);
+    if (bits != writer->input) replayFlushRun(writer);
+    writer->input = bits;
+    writer->count++;
+    writer->header.tickNum++;
+}
+
+bool replayFinish(ReplayWriter* writer, const Game& game){
+    ChecksumRecord record;
+    checksumGame(game, nullptr, &record);
+    writer->header.score = game.score;
+    writer->header.checksum = record.state;
+    writer->header.flags |= REPLAY_FINISHED;
+
+    replayFlushRun(writer);
+    fseek(writer->file, 0, SEEK_SET);
+    fwrite(&writer->header, sizeof(ReplayHeader), 1, writer->file);
+
+    bool ok = !ferror(writer->file);
+    if (fclose(writer->file) != 0) ok = false;
+    writer->file = nullptr;
+    if (!ok) cout << "Failed to write replay" << endl;
+    return ok;
+}
+
+bool replayOpen(ReplayReader* reader, const char* path){
+    memset(reader, 0, sizeof(ReplayReader));
+    if (!mapFile(&reader->file, path)) return false;
+
+    const ReplayHeader* header = (const ReplayHeader*)reader->file.data;
+    if (reader->file.size < sizeof(ReplayHeader) || header->magic != REPLAY_MAGIC || header->version != REPLAY_VERSION){
+        cout << path << " is not a version " << REPLAY_VERSION << " replay" << endl;
+        replayClose(reader);
+        return false;
+    }
+    //the counts of an unfinished replay were never patched in, it would play as empty
+    if (!(header->flags & REPLAY_FINISHED) || (header->flags & ~(uint32_t)REPLAY_FINISHED)){
+        cout << path << (header->flags & REPLAY_FINISHED ? " uses flags this version doesn't know" : " was not finished, its recording stopped early") << endl;
+        replayClose(reader);
+        return false;
+    }
+
+    reader->header = header;
+    reader->cursor = reader->file.data + sizeof(ReplayHeader);
+    reader->end = reader->file.data + reader->file.size;
+    return true;
+}
+
+void replayClose(ReplayReader* reader){
+    unmapFile(&reader->file);
+    memset(reader, 0, sizeof(ReplayReader));
+}
+
+void replayConfig(const ReplayReader& reader, GameConfig* config){
+    const ReplayHeader& header = *reader.header;
+    config->seed = header.seed;
+    config->seedSet = true;
+    config->width = header.width;
+    config->height = header.height;
+    config->rows = header.rows;
+    config->cols = header.cols;
+    config->bulletCapacity = header.bulletCapacity;
+    config->botNum = header.botNum;
+    config->fireInterval = header.fireInterval;
+}
+
+bool replayNext(ReplayReader* reader, GameInput* input){
+    if (reader->tick == reader->header->tickNum) return false;
+
+    if (!reader->left){
+        const uint8_t* cursor = reader->cursor;
+        uint64_t count = 0;
+        bool ok = cursor < reader->end;
+        if (ok){
+            reader->input = *cursor++;
+            for (int shift = 0; ; shift += 7){
+                if (cursor == reader->end || shift > 63){
+                    ok = false;
+                    break;
+                }
+                uint8_t byte = *cursor++;
+                count |= (uint64_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+        }
+        if (!ok || !count){
+            cout << "Replay is corrupt at tick " << reader->tick << endl;
+            return false;
+        }
+        reader->cursor = cursor;
+        reader->left = count;
+    }
+
+    *input = gameInputUnpack(reader->input);
+    reader->left--;
+    reader->tick++;
+    return true;
+}
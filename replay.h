@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdio>
+
+#include "game.h"
+#include "mapfile.h"
+
+#define REPLAY_MAGIC 0x50524953u //"SIRP"
+#define REPLAY_VERSION 3
+
+enum ReplayFlags : uint32_t{
+    REPLAY_FINISHED = 1 //set by replayFinish, a recorder that stopped early leaves it clear
+};
+
+//little-endian file header, followed by runNum runs of (input byte, LEB128 tick count).
+//the header carries every config field that affects the simulation, so a replay
+//re-simulates the same game whatever the command line of the player.
+struct ReplayHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    uint32_t width, height;
+    uint32_t rows, cols;
+    uint32_t bulletCapacity;
+    uint32_t botNum;
+    uint32_t fireInterval;
+    uint32_t flags;    //ReplayFlags, readers reject bits they don't know
+    uint64_t tickNum;
+    uint64_t runNum;
+    uint64_t score;    //final score claimed by the recording
+    uint64_t checksum; //state checksum after the last tick
+};
+
+struct ReplayWriter{
+    FILE* file;
+    ReplayHeader header;
+    uint8_t input;
+    uint64_t count;
+};
+
+//runs are decoded lazily straight out of the mapping
+struct ReplayReader{
+    MappedFile file;
+    const ReplayHeader* header;
+    const uint8_t* cursor;
+    const uint8_t* end;
+    uint8_t input;
+    uint64_t left;
+    uint64_t tick;
+};
+
+bool replayCreate(ReplayWriter* writer, const char* path, const GameConfig& config);
+
+//appends the input of the next tick
+void replayWrite(ReplayWriter* writer, const GameInput& input);
+
+//flushes the last run and patches the header with the counts and the final state of
+//game, prints and returns false on a write error
+bool replayFinish(ReplayWriter* writer, const Game& game);
+
+bool replayOpen(ReplayReader* reader, const char* path);
+void replayClose(ReplayReader* reader);
+
+//overwrites the simulation fields of config with the recorded ones
+void replayConfig(const ReplayReader& reader, GameConfig* config);
+
+//input of the next tick, false once every recorded tick has been played
+bool replayNext(ReplayReader* reader, GameInput* input);
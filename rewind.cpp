@@ -0,0 +1,194 @@
+#include "rewind.h"
+#include "heap.h"
+#include "snapshot.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+//a literal run ends at this many unchanged bytes, shorter gaps are cheaper to copy
+const size_t rewindMinGap = 8;
+
+static void putVarint(vector<uint8_t>* out, size_t value){
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out->push_back(value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+static size_t getVarint(const uint8_t** cursor){
+    size_t value = 0;
+    for (int shift = 0; ; shift += 7){
+        uint8_t byte = *(*cursor)++;
+        value |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+//appends state XOR base as (unchanged run, literal run, literal bytes) triples
+static void rewindEncode(vector<uint8_t>* out, const uint8_t* state, const uint8_t* base, size_t size){
+    size_t i = 0;
+    while (i < size){
+        size_t start = i;
+        for (; i + 8 <= size; i += 8){
+            uint64_t a, b;
+            memcpy(&a, state + i, 8);
+            memcpy(&b, base + i, 8);
+            if (a != b) break;
+        }
+        while (i < size && state[i] == base[i]) i++;
+        if (i == size) break;
+        putVarint(out, i - start);
+
+        size_t literal = i;
+        size_t same = 0;
+        while (i < size && same < rewindMinGap){
+            same = state[i] == base[i] ? same + 1 : 0;
+            i++;
+        }
+        i -= same;
+
+        putVarint(out, i - literal);
+        for (size_t j = literal; j < i; j++){
+            out->push_back(state[j] ^ base[j]);
+        }
+    }
+}
+
+//XORs an encoded delta into state
+static void rewindApply(uint8_t* state, const uint8_t* cursor, const uint8_t* end){
+    uint8_t* at = state;
+    while (cursor < end){
+        at += getVarint(&cursor);
+        size_t literal = getVarint(&cursor);
+        for (size_t j = 0; j < literal; j++){
+            at[j] ^= cursor[j];
+        }
+        at += literal;
+        cursor += literal;
+    }
+}
+
+static RewindSegment& rewindSegment(const RewindBuffer& rewind, uint64_t tick){
+    return rewind.segments[tick / rewind.keyInterval % rewind.segmentNum];
+}
+
+void rewindInit(RewindBuffer* rewind, const Game& game, size_t seconds, size_t keyInterval){
+    rewind->stateSize = gameStateSize(game);
+    rewind->keyInterval = keyInterval ? keyInterval : 1;
+    //one extra segment so that a full window survives while the newest one fills
+    rewind->segmentNum = (seconds * 60 + rewind->keyInterval - 1) / rewind->keyInterval + 1;
+    rewind->segments = new RewindSegment[rewind->segmentNum];
+    for (size_t i = 0; i < rewind->segmentNum; i++){
+        rewind->segments[i].count = 0;
+    }
+    rewind->oldest = rewind->newest = 0;
+    rewind->empty = true;
+    rewind->key = new uint8_t[rewind->stateSize];
+    rewind->state = new uint8_t[rewind->stateSize];
+    rewind->zeros = new uint8_t[rewind->stateSize];
+    memset(rewind->zeros, 0, rewind->stateSize);
+}
+
+void rewindFree(RewindBuffer* rewind){
+    delete[] rewind->segments;
+    delete[] rewind->key;
+    delete[] rewind->state;
+    delete[] rewind->zeros;
+}
+
+void rewindPush(RewindBuffer* rewind, const Game& game, const GameInput& input){
+    //segments keep their capacity, this only allocates until the history has wrapped once
+    HEAP_TAG("rewind segments");
+    uint64_t tick = game.tick;
+    RewindSegment& segment = rewindSegment(*rewind, tick);
+    gameSnapshot(game, rewind->state);
+
+    bool keyframe = rewind->empty || tick % rewind->keyInterval == 0;
+    if (keyframe){
+        //the slot's previous contents are the oldest history, drop them
+        if (segment.count && !rewind->empty) rewind->oldest = segment.first + segment.count;
+        if (rewind->empty) rewind->oldest = tick;
+        segment.first = tick;
+        segment.count = 0;
+        segment.offsets.assign(1, 0);
+        segment.data.clear();
+        memcpy(rewind->key, rewind->state, rewind->stateSize);
+    }
+
+    segment.data.push_back(gameInputPack(input));
+    rewindEncode(&segment.data, rewind->state, keyframe ? rewind->zeros : rewind->key, rewind->stateSize);
+    segment.offsets.push_back((uint32_t)segment.data.size());
+    segment.count++;
+    rewind->newest = tick;
+    rewind->empty = false;
+}
+
+static const uint8_t* rewindEntry(const RewindSegment& segment, size_t index, const uint8_t** end){
+    *end = segment.data.data() + segment.offsets[index + 1];
+    return segment.data.data() + segment.offsets[index];
+}
+
+bool rewindRestore(RewindBuffer* rewind, Game* game, uint64_t tick){
+    if (rewind->empty || tick < rewind->oldest || tick > rewind->newest){
+        cout << "Tick " << tick << " is not in the rewind buffer" << endl;
+        return false;
+    }
+
+    const RewindSegment& segment = rewindSegment(*rewind, tick);
+    const uint8_t* end;
+    const uint8_t* entry = rewindEntry(segment, 0, &end);
+    memset(rewind->state, 0, rewind->stateSize);
+    rewindApply(rewind->state, entry + 1, end);
+
+    size_t index = (size_t)(tick - segment.first);
+    if (index){
+        entry = rewindEntry(segment, index, &end);
+        rewindApply(rewind->state, entry + 1, end);
+    }
+    return gameRestore(game, rewind->state, rewind->stateSize);
+}
+
+void rewindDiscard(RewindBuffer* rewind, uint64_t tick){
+    if (rewind->empty || tick >= rewind->newest) return;
+    if (tick < rewind->oldest){
+        for (size_t i = 0; i < rewind->segmentNum; i++){
+            rewind->segments[i].count = 0;
+        }
+        rewind->empty = true;
+        return;
+    }
+
+    for (size_t i = 0; i < rewind->segmentNum; i++){
+        RewindSegment& segment = rewind->segments[i];
+        if (segment.count && segment.first > tick) segment.count = 0;
+    }
+
+    RewindSegment& segment = rewindSegment(*rewind, tick);
+    segment.count = (size_t)(tick - segment.first) + 1;
+    segment.offsets.resize(segment.count + 1);
+    segment.data.resize(segment.offsets[segment.count]);
+    rewind->newest = tick;
+
+    //later pushes are coded against this segment's keyframe again
+    const uint8_t* end;
+    const uint8_t* entry = rewindEntry(segment, 0, &end);
+    memset(rewind->key, 0, rewind->stateSize);
+    rewindApply(rewind->key, entry + 1, end);
+}
+
+GameInput rewindInput(const RewindBuffer& rewind, uint64_t tick){
+    const RewindSegment& segment = rewindSegment(rewind, tick);
+    return gameInputUnpack(segment.data[segment.offsets[(size_t)(tick - segment.first)]]);
+}
+
+size_t rewindBytes(const RewindBuffer& rewind){
+    size_t bytes = 0;
+    for (size_t i = 0; i < rewind.segmentNum; i++){
+        const RewindSegment& segment = rewind.segments[i];
+        if (segment.count) bytes += segment.offsets[segment.count] + (segment.count + 1) * sizeof(uint32_t);
+    }
+    return bytes;
+}
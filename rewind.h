@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "game.h"
+
+//one keyframe and the ticks after it. entry 0 is the keyframe, every later entry
+//is its state XORed with the keyframe, so restoring any tick decodes at most two
+//entries no matter how far back it is. an entry is the input byte that led to it
+//followed by zero-run coded bytes.
+struct RewindSegment{
+    uint64_t first;
+    size_t count;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> data;
+};
+
+//ring of the most recent segments. segment slots are picked by tick / keyInterval
+//so any tick is found without a search, and memory stays bounded because the
+//oldest segment is overwritten, with its vectors' capacity reused.
+struct RewindBuffer{
+    size_t stateSize;
+    size_t keyInterval;
+    size_t segmentNum;
+    RewindSegment* segments;
+    uint64_t oldest, newest;
+    bool empty;
+    uint8_t* key; //raw state of the newest keyframe
+    uint8_t* state; //snapshot being encoded or decoded
+    uint8_t* zeros; //keyframes are coded as a delta against this
+};
+
+//keeps at least seconds of 60Hz history for games shaped like game
+void rewindInit(RewindBuffer* rewind, const Game& game, size_t seconds, size_t keyInterval);
+void rewindFree(RewindBuffer* rewind);
+
+//records the state at game.tick, reached by applying input. ticks must be pushed
+//in order, the first push and every keyInterval-th tick start a keyframe
+void rewindPush(RewindBuffer* rewind, const Game& game, const GameInput& input);
+
+//puts game back at tick, which must be in [oldest, newest]. newer history is kept
+bool rewindRestore(RewindBuffer* rewind, Game* game, uint64_t tick);
+
+//forgets everything after tick, so that pushes can continue from a restored state
+void rewindDiscard(RewindBuffer* rewind, uint64_t tick);
+
+//input that was applied to reach tick, for re-simulating forward from a restore
+GameInput rewindInput(const RewindBuffer& rewind, uint64_t tick);
+
+//encoded bytes currently held, excluding the fixed scratch states
+size_t rewindBytes(const RewindBuffer& rewind);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+//xorshift64*, small enough to live in the game state and be replayed from its seed
+struct Rng{
+    uint64_t state;
+};
+
+inline void rngSeed(Rng* rng, uint64_t seed){
+    //splitmix the seed so that nearby seeds give unrelated streams, zero is not a valid state
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    rng->state = z ? z : 1;
+}
+
+inline uint32_t rngNext(Rng* rng){
+    uint64_t x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+//uniform in [0, n), n must be non-zero
+inline uint32_t rngRange(Rng* rng, uint32_t n){
+    return (uint32_t)(((uint64_t)rngNext(rng) * n) >> 32);
+}
@@ -0,0 +1,283 @@
+#include "scenario.h"
+#include "game.h"
+#include "replay.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+#define SCENARIO_SEED 7
+//each scenario is run this many times and the fastest kept, a slow run is more often
+//another process than the code
+#define SCENARIO_RUNS 3
+
+struct Scenario{
+    const char* name;
+    size_t rows, cols;
+    size_t bulletCapacity;
+    size_t botNum;
+    uint32_t fireInterval;
+    size_t ticks;
+    bool replay;
+};
+
+//the default wave, an endgame that keeps a handful of aliens on screen, a bullet storm,
+//the largest formation the config allows and a replay played back with checksums
+static const Scenario scenarios[] = {
+    {"default", 5, 11, 128, 0, 8, 3000, false},
+    {"endgame", 1, 3, 128, 0, 8, 3000, false},
+    {"storm", 5, 11, 4096, 64, 2, 3000, false},
+    {"stress100k", 316, 316, 4096, 64, 4, 120, false},
+    {"replay", 5, 11, 128, 3, 8, 3000, true},
+};
+
+//sweeps left and right while firing, the same every run
+static GameInput scenarioInput(uint64_t tick){
+    GameInput input;
+    input.dir = (int)((tick / 40) % 3) - 1;
+    input.fire = tick % 8 == 0;
+    return input;
+}
+
+static double percentile(const vector<uint64_t>& samples, size_t count, size_t stride, size_t offset, double fraction){
+    vector<uint64_t> sorted(count);
+    for (size_t i = 0; i < count; i++) sorted[i] = samples[i * stride + offset];
+    sort(sorted.begin(), sorted.end());
+    return sorted[(size_t)((count - 1) * fraction)] / 1000.0;
+}
+
+//times draw and step of every tick. given a reader, it plays the replay instead and checks
+//each tick as --play does against the recorded states in expected, false on divergence.
+//games that end are restarted so every scenario runs its full tick count
+static bool scenarioTime(const Scenario& scenario, const GameConfig& config, const Assets& assets, ReplayReader* reader,
+                         const vector<uint64_t>* expected, ScenarioResult* result){
+    Game* game = gameCreate(config, assets);
+    Buffer buffer;
+    buffer.width = game->width;
+    buffer.height = game->height;
+    buffer.data = new uint32_t[buffer.width * buffer.height];
+    clearBuffer(&buffer, rgbToUint32(0, 0, 0));
+
+    //one row per frame: the frame time, then each phase
+    const size_t stride = PHASE_COUNT + 1;
+    size_t ticks = reader ? (size_t)reader->header->tickNum : scenario.ticks;
+    vector<uint64_t> samples(ticks * stride);
+    uint64_t seed = config.seed;
+
+    statsReset();
+    bool same = true;
+    size_t frames = 0;
+    for (; frames < ticks; frames++){
+        GameInput input;
+        if (reader){
+            if (!replayNext(reader, &input)) break;
+        }
+        else {
+            if (gameOver(*game)) gameReset(game, assets, ++seed);
+            input = scenarioInput(frames);
+        }
+
+        uint64_t start = statsNow();
+        gameDraw(&buffer, *game, assets);
+        gameStep(game, assets, input);
+        if (reader){
+            ChecksumRecord record;
+            checksumGame(*game, &buffer, &record);
+            if (same && (frames >= expected->size() || record.state != (*expected)[frames])){
+                cout << "scenario " << scenario.name << ": playback diverged from the recording at tick " << frames << endl;
+                same = false;
+            }
+        }
+        uint64_t* row = &samples[frames * stride];
+        row[0] = statsNow() - start;
+
+        const PhaseStats& s = phaseStats();
+        for (size_t i = 0; i < PHASE_COUNT; i++) row[i + 1] = s.current[i];
+        statsEndFrame();
+    }
+
+    if (reader && same && frames != expected->size()){
+        cout << "scenario " << scenario.name << ": playback ended after " << frames << " of " << expected->size() << " ticks" << endl;
+        same = false;
+    }
+
+    memset(result, 0, sizeof(ScenarioResult));
+    strncpy(result->name, scenario.name, SCENARIO_NAME_SIZE - 1);
+    result->ticks = frames;
+    if (frames){
+        uint64_t total = 0;
+        for (size_t i = 0; i < frames; i++) total += samples[i * stride];
+        result->meanUs = total / 1000.0 / frames;
+        result->p99Us = percentile(samples, frames, stride, 0, 0.99);
+
+        const PhaseStats& s = phaseStats();
+        for (size_t i = 0; i < PHASE_COUNT; i++){
+            if (!s.total[i]) continue;
+            result->phaseMeanUs[i] = s.total[i] / 1000.0 / frames;
+            result->phaseP99Us[i] = percentile(samples, frames, stride, i + 1, 0.99);
+        }
+    }
+    statsReset();
+
+    delete[] buffer.data;
+    gameDestroy(game);
+    return same;
+}
+
+//keeps the lowest of every timing across runs
+static void scenarioKeepBest(ScenarioResult* best, const ScenarioResult& run, bool first){
+    if (first){
+        *best = run;
+        return;
+    }
+    best->meanUs = min(best->meanUs, run.meanUs);
+    best->p99Us = min(best->p99Us, run.p99Us);
+    for (size_t i = 0; i < PHASE_COUNT; i++){
+        best->phaseMeanUs[i] = min(best->phaseMeanUs[i], run.phaseMeanUs[i]);
+        best->phaseP99Us[i] = min(best->phaseP99Us[i], run.phaseP99Us[i]);
+    }
+}
+
+//plays the scenario untimed while recording it and its state after every tick, then times
+//the playback. false if the replay can't be written or the playback diverges
+static bool scenarioReplay(const Scenario& scenario, GameConfig* config, const Assets& assets, const char* path, ScenarioResult* result){
+    ReplayWriter writer;
+    if (!replayCreate(&writer, path, *config)) return false;
+
+    vector<uint64_t> expected;
+    Game* game = gameCreate(*config, assets);
+    for (uint64_t tick = 0; tick < scenario.ticks && !gameOver(*game); tick++){
+        GameInput input = scenarioInput(tick);
+        replayWrite(&writer, input);
+        gameStep(game, assets, input);
+
+        ChecksumRecord record;
+        checksumGame(*game, nullptr, &record);
+        expected.push_back(record.state);
+    }
+    bool ok = replayFinish(&writer, *game);
+    gameDestroy(game);
+
+    for (size_t run = 0; ok && run < SCENARIO_RUNS; run++){
+        ReplayReader reader;
+        ok = replayOpen(&reader, path);
+        if (!ok) break;
+        replayConfig(reader, config);
+
+        ScenarioResult current;
+        ok = scenarioTime(scenario, *config, assets, &reader, &expected, &current);
+        scenarioKeepBest(result, current, run == 0);
+        replayClose(&reader);
+    }
+
+    remove(path);
+    return ok;
+}
+
+bool scenarioRun(const Assets& assets, const char* replayPath, vector<ScenarioResult>* results){
+    results->clear();
+    for (const Scenario& scenario : scenarios){
+        GameConfig config;
+        configDefaults(&config);
+        config.rows = scenario.rows;
+        config.cols = scenario.cols;
+        config.bulletCapacity = scenario.bulletCapacity;
+        config.botNum = scenario.botNum;
+        config.fireInterval = scenario.fireInterval;
+        config.seed = SCENARIO_SEED;
+        config.seedSet = true;
+        config.headless = true;
+        if (!configValidate(&config)) return false;
+
+        ScenarioResult result;
+        if (scenario.replay){
+            if (!scenarioReplay(scenario, &config, assets, replayPath, &result)) return false;
+        }
+        else {
+            for (size_t run = 0; run < SCENARIO_RUNS; run++){
+                ScenarioResult current;
+                scenarioTime(scenario, config, assets, nullptr, nullptr, &current);
+                scenarioKeepBest(&result, current, run == 0);
+            }
+        }
+        results->push_back(result);
+    }
+    return true;
+}
+
+void scenarioPrint(const vector<ScenarioResult>& results, FILE* file){
+    for (const ScenarioResult& result : results){
+        fprintf(file, "%s: %llu ticks\n", result.name, (unsigned long long)result.ticks);
+        fprintf(file, "  %-14s %12s %12s\n", "phase", "mean us", "p99 us");
+        for (size_t i = 0; i < PHASE_COUNT; i++){
+            if (!result.phaseMeanUs[i]) continue;
+            fprintf(file, "  %-14s %12.2f %12.2f\n", phaseNames[i], result.phaseMeanUs[i], result.phaseP99Us[i]);
+        }
+        fprintf(file, "  %-14s %12.2f %12.2f\n", "frame", result.meanUs, result.p99Us);
+    }
+}
+
+bool scenarioWriteBaseline(const vector<ScenarioResult>& results, const char* path){
+    FILE* file = fopen(path, "w");
+    if (!file){
+        cout << "Failed to create baseline " << path << endl;
+        return false;
+    }
+    fprintf(file, "#scenario ticks mean_us p99_us\n");
+    for (const ScenarioResult& result : results){
+        fprintf(file, "%s %llu %.2f %.2f\n", result.name, (unsigned long long)result.ticks, result.meanUs, result.p99Us);
+    }
+    bool ok = fclose(file) == 0;
+    if (!ok) cout << "Failed to write baseline " << path << endl;
+    return ok;
+}
+
+bool scenarioCheck(const vector<ScenarioResult>& results, const char* path, double tolerance){
+    FILE* file = fopen(path, "r");
+    if (!file){
+        cout << "Failed to open baseline " << path << endl;
+        return false;
+    }
+
+    vector<ScenarioResult> baseline;
+    char line[256];
+    while (fgets(line, sizeof(line), file)){
+        if (line[0] == '#' || line[0] == '\n') continue;
+        ScenarioResult entry = {};
+        unsigned long long ticks;
+        if (sscanf(line, "%31s %llu %lf %lf", entry.name, &ticks, &entry.meanUs, &entry.p99Us) != 4){
+            cout << "Malformed baseline line: " << line;
+            fclose(file);
+            return false;
+        }
+        entry.ticks = ticks;
+        baseline.push_back(entry);
+    }
+    fclose(file);
+
+    //anything over the limit is a regression, being faster never fails
+    double limit = 1.0 + tolerance / 100.0;
+    bool ok = true;
+    printf("%-12s %12s %12s %8s %12s %12s %8s\n", "scenario", "mean us", "baseline", "change", "p99 us", "baseline", "change");
+    for (const ScenarioResult& result : results){
+        const ScenarioResult* base = nullptr;
+        for (const ScenarioResult& entry : baseline){
+            if (!strcmp(entry.name, result.name)) base = &entry;
+        }
+        if (!base){
+            printf("%-12s %12.2f %12s %8s %12.2f %12s %8s  not in baseline\n", result.name, result.meanUs, "-", "", result.p99Us, "-", "");
+            continue;
+        }
+
+        bool slower = result.meanUs > base->meanUs * limit || result.p99Us > base->p99Us * limit;
+        if (base->ticks != result.ticks) printf("%s: baseline ran %llu ticks, this run %llu\n", result.name, (unsigned long long)base->ticks, (unsigned long long)result.ticks);
+        printf("%-12s %12.2f %12.2f %+7.1f%% %12.2f %12.2f %+7.1f%%%s\n", result.name, result.meanUs, base->meanUs, 100.0 * (result.meanUs / base->meanUs - 1),
+            result.p99Us, base->p99Us, 100.0 * (result.p99Us / base->p99Us - 1), slower ? "  REGRESSION" : "");
+        if (slower) ok = false;
+    }
+    cout << (ok ? "no regressions" : "regressions") << " beyond " << tolerance << "% of " << path << endl;
+    return ok;
+}
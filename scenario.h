@@ -0,0 +1,30 @@
+#pragma once
+
+#include "assets.h"
+#include "stats.h"
+
+#include <vector>
+
+#define SCENARIO_NAME_SIZE 32
+
+//frame times of one scenario, a frame being one draw and one step
+struct ScenarioResult{
+    char name[SCENARIO_NAME_SIZE];
+    uint64_t ticks;
+    double meanUs, p99Us;
+    double phaseMeanUs[PHASE_COUNT];
+    double phaseP99Us[PHASE_COUNT];
+};
+
+//runs every scenario for its fixed tick count from a fixed seed with scripted input, so
+//runs are comparable. the replay scenario records to replayPath and deletes it after
+bool scenarioRun(const Assets& assets, const char* replayPath, std::vector<ScenarioResult>* results);
+
+void scenarioPrint(const std::vector<ScenarioResult>& results, FILE* file);
+
+//baselines are text, one "name ticks mean_us p99_us" line per scenario
+bool scenarioWriteBaseline(const std::vector<ScenarioResult>& results, const char* path);
+
+//prints each scenario against its baseline, false if any mean or p99 is more than
+//tolerance percent slower. scenarios missing from the baseline are reported and pass
+bool scenarioCheck(const std::vector<ScenarioResult>& results, const char* path, double tolerance);
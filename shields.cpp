@@ -0,0 +1,123 @@
+#include "shields.h"
+#include "simd.h"
+
+#include <cstring>
+
+//top row first, as drawn on screen
+static const char* shieldArt[SHIELD_HEIGHT] = {
+    "....@@@@@@@@@@@@@@....",
+    "...@@@@@@@@@@@@@@@@...",
+    "..@@@@@@@@@@@@@@@@@@..",
+    ".@@@@@@@@@@@@@@@@@@@@.",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@@@@@@@@@@@@@@@@",
+    "@@@@@@@......@@@@@@@@@",
+    "@@@@@@........@@@@@@@@",
+    "@@@@@..........@@@@@@@",
+    "@@@@@..........@@@@@@@"
+};
+
+#define STAMP_WIDTH 8
+#define STAMP_HEIGHT 6
+
+//bottom row first, centred on column 3 and row 2
+static const uint32_t stampRows[STAMP_HEIGHT] = {
+    0xA5, // @.@..@.@
+    0x7E, // .@@@@@@.
+    0x7F, // @@@@@@@.
+    0xFE, // .@@@@@@@
+    0x3C, // ..@@@@..
+    0x49  // @..@..@.
+};
+
+const uint32_t shieldRowMask = (1u << SHIELD_WIDTH) - 1;
+
+void shieldInit(Shield* shield, int32_t x, int32_t y){
+    shield->x = x;
+    shield->y = y;
+    for (size_t j = 0; j < SHIELD_HEIGHT; j++){
+        const char* art = shieldArt[SHIELD_HEIGHT - 1 - j];
+        uint32_t row = 0;
+        for (size_t i = 0; i < SHIELD_WIDTH; i++){
+            if (art[i] == '@') row |= 1u << i;
+        }
+        shield->rows[j] = row;
+    }
+}
+
+bool shieldHit(const Shield& shield, int32_t x, int32_t y, int32_t height, int32_t dir, int32_t* hitRow){
+    int32_t col = x - shield.x;
+    if (col < 0 || col >= SHIELD_WIDTH) return false;
+
+    int32_t first = y - shield.y;
+    int32_t last = first + height - 1;
+    if (first < 0) first = 0;
+    if (last >= SHIELD_HEIGHT) last = SHIELD_HEIGHT - 1;
+    if (first > last) return false;
+
+    uint32_t bit = 1u << col;
+    if (dir >= 0){
+        for (int32_t j = first; j <= last; j++){
+            if (shield.rows[j] & bit){
+                *hitRow = j;
+                return true;
+            }
+        }
+    }
+    else {
+        for (int32_t j = last; j >= first; j--){
+            if (shield.rows[j] & bit){
+                *hitRow = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void shieldErode(Shield* shield, int32_t col, int32_t row){
+    //lay the stamp out as a full shield plane so the erosion is a plain ANDN of every row
+    alignas(16) uint32_t stamp[SHIELD_HEIGHT];
+    memset(stamp, 0, sizeof(stamp));
+
+    int32_t shift = col - 3;
+    for (int32_t k = 0; k < STAMP_HEIGHT; k++){
+        int32_t j = row - 2 + k;
+        if (j < 0 || j >= SHIELD_HEIGHT) continue;
+        uint32_t mask = shift >= 0 ? stampRows[k] << shift : stampRows[k] >> -shift;
+        stamp[j] = mask & shieldRowMask;
+    }
+
+#if USE_SSE2
+    for (size_t j = 0; j < SHIELD_HEIGHT; j += 4){
+        __m128i rows = _mm_load_si128((const __m128i*)(shield->rows + j));
+        __m128i hole = _mm_load_si128((const __m128i*)(stamp + j));
+        _mm_store_si128((__m128i*)(shield->rows + j), _mm_andnot_si128(hole, rows));
+    }
+#else
+    for (size_t j = 0; j < SHIELD_HEIGHT; j++){
+        shield->rows[j] &= ~stamp[j];
+    }
+#endif
+}
+
+void drawShield(Buffer* buffer, const Shield& shield, uint32_t colour){
+    for (size_t j = 0; j < SHIELD_HEIGHT; j++){
+        size_t y = (size_t)shield.y + j;
+        if (y >= buffer->height) continue;
+
+        uint32_t* line = buffer->data + y * buffer->width;
+        uint32_t bits = shield.rows[j];
+        while (bits){
+            size_t x = (size_t)shield.x + lowestBit(bits);
+            if (x < buffer->width) line[x] = colour;
+            bits &= bits - 1;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "render.h"
+
+#define SHIELD_COUNT 4
+#define SHIELD_WIDTH 22
+#define SHIELD_HEIGHT 16
+
+//one bit per pixel, bit i of rows[j] is pixel (x + i, y + j). row 0 is the bottom
+//row, matching the y-up convention of drawSprite.
+struct Shield{
+    int32_t x, y;
+    alignas(16) uint32_t rows[SHIELD_HEIGHT];
+};
+
+void shieldInit(Shield* shield, int32_t x, int32_t y);
+
+//tests a one pixel wide bullet spanning [y, y + height) against the shield. the
+//row hit first in the direction of travel is returned in hitRow.
+bool shieldHit(const Shield& shield, int32_t x, int32_t y, int32_t height, int32_t dir, int32_t* hitRow);
+
+//clears an explosion shaped hole centred on (col, row) in shield space
+void shieldErode(Shield* shield, int32_t col, int32_t row);
+
+void drawShield(Buffer* buffer, const Shield& shield, uint32_t colour);
@@ -0,0 +1,98 @@
+#include "shm.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static bool sharedMap(SharedMemory* shared, const char* name, size_t size, bool create, size_t minSize){
+    memset(shared, 0, sizeof(SharedMemory));
+    shared->owner = create;
+    shared->size = size;
+
+#ifdef _WIN32
+    snprintf(shared->name, sizeof(shared->name), "Local\\space-invaders-%s", name);
+    if (create){
+        shared->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, shared->name);
+    }
+    else {
+        shared->mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, shared->name);
+    }
+    if (!shared->mapping){
+        cout << "Failed to open shared memory " << shared->name << endl;
+        return false;
+    }
+    shared->memory = (uint8_t*)MapViewOfFile((HANDLE)shared->mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (shared->memory && !size){
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(shared->memory, &info, sizeof(info));
+        shared->size = info.RegionSize;
+    }
+    if (!shared->memory || shared->size < minSize){
+        cout << "Failed to map shared memory " << shared->name << endl;
+        sharedClose(shared);
+        return false;
+    }
+#else
+    snprintf(shared->name, sizeof(shared->name), "/space-invaders-%s", name);
+    shared->fd = shm_open(shared->name, create ? O_CREAT | O_RDWR : O_RDWR, 0600);
+    if (shared->fd < 0){
+        cout << "Failed to open shared memory " << shared->name << endl;
+        return false;
+    }
+    if (create){
+        if (ftruncate(shared->fd, (off_t)size) != 0){
+            cout << "Failed to size shared memory " << shared->name << endl;
+            sharedClose(shared);
+            return false;
+        }
+    }
+    else {
+        struct stat info;
+        fstat(shared->fd, &info);
+        shared->size = (size_t)info.st_size;
+    }
+    void* memory = shared->size >= minSize && shared->size ? mmap(nullptr, shared->size, PROT_READ | PROT_WRITE, MAP_SHARED, shared->fd, 0) : MAP_FAILED;
+    if (memory == MAP_FAILED){
+        cout << "Failed to map shared memory " << shared->name << endl;
+        sharedClose(shared);
+        return false;
+    }
+    shared->memory = (uint8_t*)memory;
+#endif
+    return true;
+}
+
+bool sharedCreate(SharedMemory* shared, const char* name, size_t size){
+    return sharedMap(shared, name, size, true, size);
+}
+
+bool sharedOpen(SharedMemory* shared, const char* name, size_t minSize){
+    return sharedMap(shared, name, 0, false, minSize);
+}
+
+void sharedClose(SharedMemory* shared){
+#ifdef _WIN32
+    if (shared->memory) UnmapViewOfFile(shared->memory);
+    if (shared->mapping) CloseHandle((HANDLE)shared->mapping);
+#else
+    if (shared->memory) munmap(shared->memory, shared->size);
+    if (shared->fd >= 0) close(shared->fd);
+    if (shared->owner && shared->name[0]) shm_unlink(shared->name);
+#endif
+    memset(shared, 0, sizeof(SharedMemory));
+#ifndef _WIN32
+    shared->fd = -1;
+#endif
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//named shared memory region, a POSIX shm object or a Windows pagefile mapping
+struct SharedMemory{
+    uint8_t* memory;
+    size_t size;
+    bool owner;
+    char name[64];
+#ifdef _WIN32
+    void* mapping;
+#else
+    int fd;
+#endif
+};
+
+//creates and maps size bytes under NAME, replacing a stale region left behind by a crash
+bool sharedCreate(SharedMemory* shared, const char* name, size_t size);
+
+//maps an existing region whole, fails if it is smaller than minSize
+bool sharedOpen(SharedMemory* shared, const char* name, size_t minSize);
+
+//unmaps, and removes the name if this side created it
+void sharedClose(SharedMemory* shared);
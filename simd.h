@@ -0,0 +1,34 @@
+#pragma once
+
+//SSE2 is baseline on x64, so the vector paths are on by default there.
+//define NO_SIMD to force the scalar fallbacks.
+#if !defined(NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define USE_SSE2 0
+#endif
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//index of the lowest set bit, mask must be non-zero
+inline uint32_t lowestBit(uint32_t mask){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+//pause hint for spin-wait loops
+inline void cpuRelax(){
+#if USE_SSE2
+    _mm_pause();
+#endif
+}
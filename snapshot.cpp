@@ -0,0 +1,56 @@
+#include "snapshot.h"
+#include "mapfile.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static bool snapshotValid(const void* src, size_t size){
+    const StateHeader* header = (const StateHeader*)src;
+    return size >= STATE_HEADER_SIZE + sizeof(Game) && header->magic == STATE_MAGIC &&
+           header->version == STATE_VERSION && header->size == size;
+}
+
+void gameSnapshot(const Game& game, void* dst){
+    memcpy(dst, gameHeader(&game), gameStateSize(game));
+}
+
+bool gameRestore(Game* game, const void* src, size_t size){
+    if (!snapshotValid(src, size) || size != gameStateSize(*game)){
+        cout << "Snapshot doesn't match this game" << endl;
+        return false;
+    }
+    memcpy(gameHeader(game), src, size);
+    return true;
+}
+
+bool gameSave(const Game& game, const char* path){
+    FILE* file = fopen(path, "wb");
+    if (!file){
+        cout << "Failed to create " << path << endl;
+        return false;
+    }
+
+    bool ok = fwrite(gameHeader(&game), 1, gameStateSize(game), file) == gameStateSize(game);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) cout << "Failed to write " << path << endl;
+    return ok;
+}
+
+Game* gameLoad(const char* path){
+    MappedFile file;
+    if (!mapFile(&file, path)) return nullptr;
+
+    if (!file.data || !snapshotValid(file.data, file.size)){
+        cout << path << " is not a version " << STATE_VERSION << " save state" << endl;
+        unmapFile(&file);
+        return nullptr;
+    }
+
+    //copied out rather than used in place, the mapping is read-only and the game must be writable
+    uint8_t* block = new uint8_t[file.size];
+    memcpy(block, file.data, file.size);
+    unmapFile(&file);
+    return (Game*)(block + STATE_HEADER_SIZE);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "game.h"
+
+//a game's state is one position independent block (see StateHeader), so these
+//are single copies with no per-field serialization. files are only loadable by
+//builds with the same Game layout, the version guards against mixing them.
+
+inline size_t gameStateSize(const Game& game){
+    return (size_t)gameHeader(&game)->size;
+}
+
+//copies the whole state into dst, which must hold gameStateSize bytes
+void gameSnapshot(const Game& game, void* dst);
+
+//overwrites game with a snapshot taken from a game of the same shape, prints and
+//returns false if src isn't one
+bool gameRestore(Game* game, const void* src, size_t size);
+
+bool gameSave(const Game& game, const char* path);
+
+//maps a saved state and copies it into a new block, free it with gameDestroy
+Game* gameLoad(const char* path);
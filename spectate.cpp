@@ -0,0 +1,415 @@
+#include "spectate.h"
+#include "heap.h"
+#include "checksum.h"
+#include "stats.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static void socketPath(char* path, size_t size, const char* name){
+    snprintf(path, size, "/tmp/space-invaders-%s.sock", name);
+}
+
+static bool sendAll(intptr_t socket, const uint8_t* data, size_t size){
+#ifdef _WIN32
+    return false;
+#else
+    while (size){
+        ssize_t sent = send((int)socket, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+#endif
+}
+
+static bool receiveAll(intptr_t socket, void* data, size_t size){
+#ifdef _WIN32
+    return false;
+#else
+    uint8_t* at = (uint8_t*)data;
+    while (size){
+        ssize_t got = recv((int)socket, at, size, 0);
+        if (got <= 0) return false;
+        at += got;
+        size -= (size_t)got;
+    }
+    return true;
+#endif
+}
+
+static void closeSocket(intptr_t socket){
+#ifndef _WIN32
+    close((int)socket);
+#endif
+}
+
+static void putVarint(vector<uint8_t>* out, size_t value){
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out->push_back(value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+static bool getVarint(const uint8_t** cursor, const uint8_t* end, size_t* value){
+    *value = 0;
+    for (int shift = 0; *cursor < end && shift < 64; shift += 7){
+        uint8_t byte = *(*cursor)++;
+        *value |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+//palette index of every pixel, split into bitplanes. the last colour is cached since
+//frames are mostly long runs of one colour. returns false if the palette overflowed
+static bool spectatePlanes(SpectateServer* server, bool* grew){
+    size_t pixelNum = server->width * server->height;
+    const uint32_t* frame = server->frame;
+    *grew = false;
+
+    uint32_t lastColour = server->palette[0];
+    uint32_t lastIndex = 0;
+    size_t planeNum = server->planeNum;
+    memset(server->planes, 0, 8 * server->wordNum * sizeof(uint64_t));
+    for (size_t i = 0; i < pixelNum; i++){
+        uint32_t colour = frame[i];
+        if (colour != lastColour || !server->paletteNum){
+            size_t index = 0;
+            while (index < server->paletteNum && server->palette[index] != colour) index++;
+            if (index == server->paletteNum){
+                if (index == SPECTATE_MAX_COLOURS) return false;
+                server->palette[server->paletteNum++] = colour;
+                while (((size_t)1 << planeNum) < server->paletteNum) planeNum++;
+                *grew = true;
+            }
+            lastColour = colour;
+            lastIndex = (uint32_t)index;
+        }
+        for (uint32_t bits = lastIndex, plane = 0; bits; bits >>= 1, plane++){
+            if (bits & 1) server->planes[plane * server->wordNum + i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+    server->planeNum = (uint8_t)planeNum;
+    return true;
+}
+
+static void spectateEncode(SpectateServer* server, uint64_t frame, uint64_t hash, bool key){
+    const uint64_t* base = key ? server->zeros : server->previous;
+    size_t wordNum = server->planeNum * server->wordNum;
+
+    vector<uint8_t>& message = server->message;
+    message.resize(sizeof(SpectateHeader));
+    const uint8_t* colours = (const uint8_t*)server->palette;
+    message.insert(message.end(), colours, colours + server->paletteNum * sizeof(uint32_t));
+
+    size_t i = 0;
+    while (i < wordNum){
+        size_t start = i;
+        while (i < wordNum && server->planes[i] == base[i]) i++;
+        if (i == wordNum) break;
+        size_t literal = i;
+        while (i < wordNum && server->planes[i] != base[i]) i++;
+
+        putVarint(&message, literal - start);
+        putVarint(&message, i - literal);
+        for (size_t j = literal; j < i; j++){
+            uint64_t word = server->planes[j] ^ base[j];
+            const uint8_t* bytes = (const uint8_t*)&word;
+            message.insert(message.end(), bytes, bytes + 8);
+        }
+    }
+
+    SpectateHeader header;
+    header.magic = SPECTATE_MAGIC;
+    header.size = (uint32_t)(message.size() - sizeof(SpectateHeader));
+    header.frame = frame;
+    header.hash = hash;
+    header.width = (uint32_t)server->width;
+    header.height = (uint32_t)server->height;
+    header.paletteNum = (uint16_t)server->paletteNum;
+    header.planeNum = server->planeNum;
+    header.key = key;
+    memcpy(message.data(), &header, sizeof(header));
+}
+
+static void spectateAccept(SpectateServer* server){
+    HEAP_TAG("spectator clients");
+#ifndef _WIN32
+    for (;;){
+        int client = accept((int)server->listener, nullptr, nullptr);
+        if (client < 0) return;
+        if (server->clients.size() == SPECTATE_MAX_CLIENTS){
+            close(client);
+            continue;
+        }
+        server->clients.push_back(client);
+        server->keyed.push_back(false);
+    }
+#endif
+}
+
+//codes one frame for everybody, a keyframe only goes to spectators that have none yet
+static void spectateFrame(SpectateServer* server, uint64_t frame){
+    uint64_t start = statsNow();
+    spectateAccept(server);
+
+    bool grew;
+    if (!spectatePlanes(server, &grew)){
+        //more colours than an index can hold, start over with a fresh palette
+        server->paletteNum = 0;
+        server->planeNum = 0;
+        spectatePlanes(server, &grew);
+        grew = true;
+    }
+    uint64_t hash = hashBytes(server->frame, server->width * server->height * sizeof(uint32_t), 0);
+
+    //a new colour can change the plane count, so the old planes no longer line up
+    for (size_t pass = 0; pass < 2; pass++){
+        bool key = pass == 0;
+        bool needed = false;
+        for (size_t i = 0; i < server->clients.size(); i++){
+            if (key == (!server->keyed[i] || grew)) needed = true;
+        }
+        if (!needed) continue;
+
+        spectateEncode(server, frame, hash, key);
+        server->stats.bytes += server->message.size();
+        if (key) server->stats.keyframes++;
+        for (size_t i = 0; i < server->clients.size();){
+            if (key != (!server->keyed[i] || grew)){
+                i++;
+                continue;
+            }
+            if (!sendAll(server->clients[i], server->message.data(), server->message.size())){
+                closeSocket(server->clients[i]);
+                server->clients.erase(server->clients.begin() + i);
+                server->keyed.erase(server->keyed.begin() + i);
+                continue;
+            }
+            i++;
+        }
+    }
+    for (size_t i = 0; i < server->keyed.size(); i++){
+        server->keyed[i] = true;
+    }
+
+    uint64_t* swap = server->previous;
+    server->previous = server->planes;
+    server->planes = swap;
+
+    uint64_t elapsed = statsNow() - start;
+    server->stats.encoded++;
+    server->stats.encodeNs += elapsed;
+    if (elapsed > server->stats.maxEncodeNs) server->stats.maxEncodeNs = elapsed;
+}
+
+static void spectateEncoder(SpectateServer* server){
+    for (;;){
+        uint64_t frame;
+        {
+            unique_lock<mutex> guard(server->lock);
+            server->ready.wait(guard, [server](){ return server->hasPending || server->quit; });
+            if (!server->hasPending) break;
+            uint32_t* swap = server->frame;
+            server->frame = server->pending;
+            server->pending = swap;
+            frame = server->pendingFrame;
+            server->hasPending = false;
+        }
+        spectateFrame(server, frame);
+    }
+}
+
+bool spectateServerStart(SpectateServer* server, const char* name, size_t width, size_t height){
+#ifdef _WIN32
+    cout << "Spectating needs Unix domain sockets, which this build doesn't use" << endl;
+    return false;
+#else
+    socketPath(server->path, sizeof(server->path), name);
+    unlink(server->path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    socketPath(address.sun_path, sizeof(address.sun_path), name);
+    if (listener < 0 || bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 4) != 0){
+        cout << "Failed to listen on " << server->path << endl;
+        if (listener >= 0) close(listener);
+        return false;
+    }
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+    server->listener = listener;
+    server->width = width;
+    server->height = height;
+    server->wordNum = (width * height + 63) / 64;
+    size_t pixelNum = width * height;
+    server->pending = new uint32_t[pixelNum];
+    server->frame = new uint32_t[pixelNum];
+    server->hasPending = false;
+    server->quit = false;
+    server->paletteNum = 0;
+    server->planeNum = 0;
+    memset(server->palette, 0, sizeof(server->palette));
+    //8 planes hold any palette index
+    server->planes = new uint64_t[8 * server->wordNum];
+    server->previous = new uint64_t[8 * server->wordNum];
+    server->zeros = new uint64_t[8 * server->wordNum];
+    memset(server->previous, 0, 8 * server->wordNum * sizeof(uint64_t));
+    memset(server->zeros, 0, 8 * server->wordNum * sizeof(uint64_t));
+    memset(&server->stats, 0, sizeof(SpectateStats));
+    server->encoder = thread(spectateEncoder, server);
+    return true;
+#endif
+}
+
+void spectateSubmit(SpectateServer* server, const Buffer& buffer, uint64_t frame){
+    {
+        lock_guard<mutex> guard(server->lock);
+        memcpy(server->pending, buffer.data, server->width * server->height * sizeof(uint32_t));
+        server->pendingFrame = frame;
+        server->hasPending = true;
+        server->stats.submitted++;
+    }
+    server->ready.notify_one();
+}
+
+void spectateServerStop(SpectateServer* server){
+    {
+        lock_guard<mutex> guard(server->lock);
+        server->quit = true;
+    }
+    server->ready.notify_one();
+    server->encoder.join();
+
+    for (intptr_t client : server->clients){
+        closeSocket(client);
+    }
+    server->clients.clear();
+    closeSocket(server->listener);
+#ifndef _WIN32
+    unlink(server->path);
+#endif
+    delete[] server->pending;
+    delete[] server->frame;
+    delete[] server->planes;
+    delete[] server->previous;
+    delete[] server->zeros;
+}
+
+static bool spectateReadHeader(SpectateClient* client){
+    if (client->hasHeader) return true;
+    if (!receiveAll(client->socket, &client->header, sizeof(SpectateHeader))) return false;
+    const SpectateHeader& header = client->header;
+    if (header.magic != SPECTATE_MAGIC || header.paletteNum > SPECTATE_MAX_COLOURS || header.planeNum > 8){
+        cout << "Spectator stream is corrupt" << endl;
+        return false;
+    }
+    client->hasHeader = true;
+    return true;
+}
+
+bool spectateConnect(SpectateClient* client, const char* name){
+    client->planes = nullptr;
+    client->hasHeader = false;
+    client->frames = client->bytes = client->mismatches = 0;
+#ifdef _WIN32
+    cout << "Spectating needs Unix domain sockets, which this build doesn't use" << endl;
+    return false;
+#else
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    socketPath(address.sun_path, sizeof(address.sun_path), name);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (const sockaddr*)&address, sizeof(address)) != 0){
+        cout << "Failed to connect to " << address.sun_path << endl;
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    client->socket = fd;
+
+    if (!spectateReadHeader(client)){
+        close(fd);
+        return false;
+    }
+    client->width = client->header.width;
+    client->height = client->header.height;
+    client->wordNum = (client->width * client->height + 63) / 64;
+    client->planes = new uint64_t[8 * client->wordNum];
+    memset(client->planes, 0, 8 * client->wordNum * sizeof(uint64_t));
+    return true;
+#endif
+}
+
+void spectateDisconnect(SpectateClient* client){
+    closeSocket(client->socket);
+    delete[] client->planes;
+    client->planes = nullptr;
+}
+
+bool spectateNext(SpectateClient* client, Buffer* buffer){
+    if (!spectateReadHeader(client)) return false;
+    client->hasHeader = false;
+    const SpectateHeader& header = client->header;
+    if (header.width != client->width || header.height != client->height) return false;
+
+    client->payload.resize(header.size);
+    if (!receiveAll(client->socket, client->payload.data(), header.size)) return false;
+    client->bytes += sizeof(SpectateHeader) + header.size;
+
+    const uint8_t* cursor = client->payload.data();
+    const uint8_t* end = cursor + header.size;
+    if (header.size < header.paletteNum * sizeof(uint32_t)) return false;
+    memcpy(client->palette, cursor, header.paletteNum * sizeof(uint32_t));
+    cursor += header.paletteNum * sizeof(uint32_t);
+
+    size_t wordNum = header.planeNum * client->wordNum;
+    if (header.key) memset(client->planes, 0, 8 * client->wordNum * sizeof(uint64_t));
+    size_t at = 0;
+    while (cursor < end){
+        size_t zeros, literal;
+        if (!getVarint(&cursor, end, &zeros) || !getVarint(&cursor, end, &literal)) return false;
+        at += zeros;
+        if (at + literal > wordNum || (size_t)(end - cursor) < literal * 8) return false;
+        for (size_t j = 0; j < literal; j++){
+            uint64_t word;
+            memcpy(&word, cursor, 8);
+            client->planes[at++] ^= word;
+            cursor += 8;
+        }
+    }
+
+    //gather each pixel's index back out of the planes
+    size_t pixelNum = client->width * client->height;
+    for (size_t i = 0; i < pixelNum; i++){
+        uint32_t index = 0;
+        for (size_t plane = 0; plane < header.planeNum; plane++){
+            index |= (uint32_t)((client->planes[plane * client->wordNum + i / 64] >> (i % 64)) & 1) << plane;
+        }
+        buffer->data[i] = index < header.paletteNum ? client->palette[index] : 0;
+    }
+
+    if (hashBytes(buffer->data, pixelNum * sizeof(uint32_t), 0) != header.hash) client->mismatches++;
+    client->frames++;
+    return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "render.h"
+
+#define SPECTATE_MAGIC 0x50534953u //"SISP"
+#define SPECTATE_MAX_COLOURS 256
+#define SPECTATE_MAX_CLIENTS 16
+
+//one frame on the wire. the frame is mapped through the palette to colour indices,
+//split into planeNum bitplanes of 64-pixel words and XORed with the previous frame's
+//planes, or with zero for a keyframe. the mostly zero words that leaves are sent as
+//(zero run, literal run, literal words) triples after the palette.
+struct SpectateHeader{
+    uint32_t magic;
+    uint32_t size; //bytes after this header
+    uint64_t frame;
+    uint64_t hash; //of the source frame, so spectators can check their rebuild
+    uint32_t width, height;
+    uint16_t paletteNum;
+    uint8_t planeNum;
+    uint8_t key;
+};
+
+struct SpectateStats{
+    uint64_t submitted;
+    uint64_t encoded;
+    uint64_t keyframes;
+    uint64_t bytes;
+    uint64_t encodeNs;
+    uint64_t maxEncodeNs;
+};
+
+//game side. spectateSubmit copies the frame into a mailbox and returns, an encoder
+//thread codes whatever is newest and writes it to every connected spectator, so a
+//slow spectator or encoder costs the game a copy and never a frame. frames the
+//encoder didn't get to are skipped, which is safe because deltas are taken against
+//the last frame it actually sent.
+struct SpectateServer{
+    size_t width, height;
+    size_t wordNum; //per plane
+    intptr_t listener;
+    char path[108];
+
+    std::mutex lock;
+    std::condition_variable ready;
+    uint32_t* pending;
+    uint64_t pendingFrame;
+    bool hasPending;
+    bool quit;
+    std::thread encoder;
+
+    //encoder thread only
+    uint32_t* frame;
+    std::vector<intptr_t> clients;
+    std::vector<bool> keyed;
+    uint32_t palette[SPECTATE_MAX_COLOURS];
+    size_t paletteNum;
+    uint8_t planeNum;
+    uint64_t* planes;
+    uint64_t* previous;
+    uint64_t* zeros;
+    std::vector<uint8_t> message;
+    SpectateStats stats;
+};
+
+//listens on the local socket for NAME, prints and returns false if it can't
+bool spectateServerStart(SpectateServer* server, const char* name, size_t width, size_t height);
+void spectateSubmit(SpectateServer* server, const Buffer& buffer, uint64_t frame);
+
+//encodes the last pending frame, then disconnects everyone
+void spectateServerStop(SpectateServer* server);
+
+//spectator side, rebuilds frames from the stream
+struct SpectateClient{
+    intptr_t socket;
+    SpectateHeader header;
+    bool hasHeader;
+    size_t width, height;
+    size_t wordNum;
+    uint32_t palette[SPECTATE_MAX_COLOURS];
+    uint64_t* planes;
+    std::vector<uint8_t> payload;
+    uint64_t frames, bytes, mismatches;
+};
+
+//connects and reads the first frame's header, so width and height are known
+bool spectateConnect(SpectateClient* client, const char* name);
+void spectateDisconnect(SpectateClient* client);
+
+//applies the next frame and draws it into buffer, which must be width x height.
+//false once the game has ended the stream
+bool spectateNext(SpectateClient* client, Buffer* buffer);
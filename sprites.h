@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//sprites are written as ascii art, '@' for a set pixel and '.' for a clear one, one
+//string per row, top row first. adjacent literals concatenate, so a sprite is simply
+//its rows one after another:
+//
+//  "..@@.."
+//  ".@..@."
+//
+//and is baked at compile time into one bit mask per row, bit i being column i. rows
+//are stored bottom row first, the order they are drawn in, since the frame buffer
+//grows upwards.
+
+#define SPRITE_MAX_WIDTH 32
+
+//height rows of a single sprite, or of count glyphs of a sheet back to back
+template <size_t Rows>
+struct SpriteRows{
+    uint32_t rows[Rows];
+};
+
+//true if art holds exactly count sprites of width x height pixels of '@' and '.'
+template <size_t N>
+constexpr bool spriteArtValid(const char (&art)[N], size_t width, size_t height, size_t count = 1){
+    if (!width || width > SPRITE_MAX_WIDTH || N - 1 != width * height * count) return false;
+    for (size_t i = 0; i + 1 < N; i++){
+        if (art[i] != '@' && art[i] != '.') return false;
+    }
+    return true;
+}
+
+template <size_t Width, size_t Height, size_t Count = 1, size_t N>
+constexpr SpriteRows<Height * Count> spriteBake(const char (&art)[N]){
+    SpriteRows<Height * Count> baked = {};
+    for (size_t glyph = 0; glyph < Count; glyph++){
+        for (size_t row = 0; row < Height; row++){
+            uint32_t mask = 0;
+            for (size_t col = 0; col < Width; col++){
+                if (art[(glyph * Height + row) * Width + col] == '@') mask |= 1u << col;
+            }
+            baked.rows[glyph * Height + Height - 1 - row] = mask;
+        }
+    }
+    return baked;
+}
+
+//bakes art into a read-only constant name, malformed art fails the build
+#define SPRITE_BAKE(name, width, height, art) \
+    static_assert(spriteArtValid(art, width, height), #name " must be " #width "x" #height " pixels of '@' and '.'"); \
+    static constexpr SpriteRows<height> name = spriteBake<width, height>(art)
+
+//the same for a sheet of count equally sized glyphs
+#define SPRITE_BAKE_SHEET(name, width, height, count, art) \
+    static_assert(spriteArtValid(art, width, height, count), #name " must be " #count " glyphs of " #width "x" #height " pixels of '@' and '.'"); \
+    static constexpr SpriteRows<(height) * (count)> name = spriteBake<width, height, count>(art)
@@ -0,0 +1,191 @@
+#include "stats.h"
+#include "heap.h"
+
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+const char* phaseNames[PHASE_COUNT] = {
+    "input",
+    "clear",
+    "hud",
+    "draw aliens",
+    "draw shields",
+    "draw player",
+    "draw bullets",
+    "animation",
+    "march",
+    "timers",
+    "collision",
+    "player",
+    "upload",
+    "swap",
+    "sleep"
+};
+
+static thread_local PhaseStats stats;
+static thread_local bool statsStarted = false;
+static thread_local Phase running = PHASE_COUNT;
+
+uint64_t statsNow(){
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PhaseStats& phaseStats(){
+    if (!statsStarted) statsReset();
+    return stats;
+}
+
+void statsReset(){
+    memset(&stats, 0, sizeof(PhaseStats));
+    stats.frameStart = statsNow();
+    statsStarted = true;
+}
+
+void statsAdd(Phase phase, uint64_t ns){
+    phaseStats().current[phase] += ns;
+}
+
+Phase statsEnter(Phase phase){
+    Phase outer = running;
+    running = phase;
+    return outer;
+}
+
+void statsLeave(Phase outer){
+    running = outer;
+}
+
+void statsAllocation(size_t bytes){
+    PhaseStats& s = phaseStats();
+    s.allocations[running]++;
+    s.allocatedBytes[running] += bytes;
+    s.frameAllocations++;
+    s.heapNet += (int64_t)bytes;
+    if (s.heapNet - s.heapFrameBase > s.heapFramePeak) s.heapFramePeak = s.heapNet - s.heapFrameBase;
+}
+
+void statsFree(size_t bytes){
+    phaseStats().heapNet -= (int64_t)bytes;
+}
+
+static uint32_t statsBucket(uint64_t ns){
+    uint64_t us = ns / 1000;
+    uint32_t bucket = 0;
+    while (us && bucket < STATS_BUCKETS - 1){
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void statsEndFrame(){
+    PhaseStats& s = phaseStats();
+    uint64_t now = statsNow();
+    uint64_t frame = now - s.frameStart;
+    traceRecord(PHASE_COUNT, s.frameStart, now);
+
+    if (s.windowFrames[s.window] == STATS_WINDOW){
+        s.window ^= 1;
+        s.windowFrames[s.window] = 0;
+        s.overBudget[s.window] = 0;
+        memset(s.histogram[s.window], 0, sizeof(s.histogram[s.window]));
+    }
+    uint32_t (*histogram)[STATS_BUCKETS] = s.histogram[s.window];
+    s.windowFrames[s.window]++;
+    if (frame > STATS_BUDGET_NS) s.overBudget[s.window]++;
+    histogram[PHASE_COUNT][statsBucket(frame)]++;
+
+    for (size_t i = 0; i < PHASE_COUNT; i++){
+        if (s.current[i]) histogram[i][statsBucket(s.current[i])]++;
+        s.total[i] += s.current[i];
+        if (s.current[i] > s.max[i]) s.max[i] = s.current[i];
+        s.current[i] = 0;
+    }
+
+    s.frameTotal += frame;
+    if (frame > s.frameMax) s.frameMax = frame;
+    s.frameStart = now;
+    s.frames++;
+
+    if (s.frameAllocations) s.allocatingFrames++;
+    if (s.frameAllocations > s.frameAllocationsMax) s.frameAllocationsMax = s.frameAllocations;
+    if (s.heapFramePeak > s.heapFramePeakMax) s.heapFramePeakMax = s.heapFramePeak;
+    s.frameAllocations = 0;
+    s.heapFrameBase = s.heapNet;
+    s.heapFramePeak = 0;
+}
+
+//upper bound of the bucket holding the given fraction of the counts, in microseconds
+static uint64_t statsPercentile(const uint32_t* counts, double fraction){
+    uint64_t total = 0;
+    for (size_t b = 0; b < STATS_BUCKETS; b++) total += counts[b];
+    uint64_t seen = 0;
+    for (size_t b = 0; b < STATS_BUCKETS; b++){
+        seen += counts[b];
+        if (seen && seen >= fraction * total) return (uint64_t)1 << b;
+    }
+    return (uint64_t)1 << (STATS_BUCKETS - 1);
+}
+
+//percentiles of the recent frames and a bar per bucket, to see where the frame budget goes
+static void statsPrintHistograms(FILE* file){
+    const PhaseStats& s = phaseStats();
+    uint32_t frames = s.windowFrames[0] + s.windowFrames[1];
+    fprintf(file, "last %u frames, %u over the %.1f ms budget\n", frames, s.overBudget[0] + s.overBudget[1], STATS_BUDGET_NS / 1e6);
+    fprintf(file, "%-14s %9s %9s %9s  buckets from <1 us doubling\n", "phase", "p50 <us", "p90 <us", "p99 <us");
+
+    static const char bars[] = " .:-=+*#";
+    for (size_t i = 0; i <= PHASE_COUNT; i++){
+        uint32_t counts[STATS_BUCKETS];
+        uint32_t most = 0;
+        for (size_t b = 0; b < STATS_BUCKETS; b++){
+            counts[b] = s.histogram[0][i][b] + s.histogram[1][i][b];
+            if (counts[b] > most) most = counts[b];
+        }
+        if (!most) continue;
+
+        char graph[STATS_BUCKETS + 1];
+        for (size_t b = 0; b < STATS_BUCKETS; b++){
+            graph[b] = counts[b] ? bars[1 + (size_t)counts[b] * (sizeof(bars) - 3) / most] : bars[0];
+        }
+        graph[STATS_BUCKETS] = '\0';
+        fprintf(file, "%-14s %9llu %9llu %9llu  |%s|\n", i < PHASE_COUNT ? phaseNames[i] : "frame", (unsigned long long)statsPercentile(counts, 0.5),
+            (unsigned long long)statsPercentile(counts, 0.9), (unsigned long long)statsPercentile(counts, 0.99), graph);
+    }
+}
+
+void statsPrint(FILE* file){
+    const PhaseStats& s = phaseStats();
+    if (!s.frames) return;
+
+#if HEAP_TRACK
+    fprintf(file, "%-14s %12s %12s %8s %12s %12s\n", "phase", "mean us", "max us", "share", "allocs", "KB");
+#else
+    fprintf(file, "%-14s %12s %12s %8s\n", "phase", "mean us", "max us", "share");
+#endif
+    for (size_t i = 0; i < PHASE_COUNT; i++){
+        if (!s.total[i] && !s.allocations[i]) continue;
+        fprintf(file, "%-14s %12.2f %12.2f %7.1f%%", phaseNames[i], s.total[i] / 1000.0 / s.frames, s.max[i] / 1000.0,
+            100.0 * s.total[i] / (s.frameTotal ? s.frameTotal : 1));
+#if HEAP_TRACK
+        fprintf(file, " %12llu %12.1f", (unsigned long long)s.allocations[i], s.allocatedBytes[i] / 1024.0);
+#endif
+        fprintf(file, "\n");
+    }
+#if HEAP_TRACK
+    fprintf(file, "%-14s %12s %12s %8s %12llu %12.1f\n", "other", "", "", "", (unsigned long long)s.allocations[PHASE_COUNT],
+        s.allocatedBytes[PHASE_COUNT] / 1024.0);
+#endif
+    fprintf(file, "%-14s %12.2f %12.2f\n", "frame", s.frameTotal / 1000.0 / s.frames, s.frameMax / 1000.0);
+    fprintf(file, "%llu frames, %.1f frames/s\n", (unsigned long long)s.frames, s.frames * 1e9 / (s.frameTotal ? s.frameTotal : 1));
+    statsPrintHistograms(file);
+
+#if HEAP_TRACK
+    fprintf(file, "heap: %llu of %llu frames allocated, at most %llu allocations and %.1f KB growth in one frame, %.1f KB live, %.1f KB peak\n",
+        (unsigned long long)s.allocatingFrames, (unsigned long long)s.frames, (unsigned long long)s.frameAllocationsMax,
+        s.heapFramePeakMax / 1024.0, heapLive() / 1024.0, heapPeak() / 1024.0);
+    heapPrintTags(file);
+#endif
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "trace.h"
+
+//phase timers cost two clock reads each, define PHASE_TIMING to 0 to compile them out.
+//frames are still timed and counted
+#if !defined(PHASE_TIMING)
+#define PHASE_TIMING 1
+#endif
+
+//rolling histograms: bucket 0 counts times under 1 us, bucket b times under 2^b us and
+//the last everything longer. they cover the last one to two windows of frames
+#define STATS_BUCKETS 20
+#define STATS_WINDOW 600
+#define STATS_BUDGET_NS 16666667
+
+enum Phase{
+    PHASE_INPUT = 0,
+    PHASE_CLEAR,
+    PHASE_HUD,
+    PHASE_DRAW_ALIENS,
+    PHASE_DRAW_SHIELDS,
+    PHASE_DRAW_PLAYER,
+    PHASE_DRAW_BULLETS,
+    PHASE_ANIMATION,
+    PHASE_MARCH,
+    PHASE_TIMERS,
+    PHASE_COLLISION,
+    PHASE_PLAYER,
+    PHASE_UPLOAD,
+    PHASE_SWAP,
+    PHASE_SLEEP,
+    PHASE_COUNT
+};
+
+extern const char* phaseNames[PHASE_COUNT];
+
+//per-thread running totals, one frame is everything between two statsEndFrame calls
+struct PhaseStats{
+    uint64_t frames;
+    uint64_t frameStart;
+    uint64_t frameTotal, frameMax;
+    uint64_t current[PHASE_COUNT];
+    uint64_t total[PHASE_COUNT];
+    uint64_t max[PHASE_COUNT];
+
+    //two windows, the current one is cleared as the other fills. the extra slot is the frame
+    uint32_t window;
+    uint32_t windowFrames[2];
+    uint32_t overBudget[2];
+    uint32_t histogram[2][PHASE_COUNT + 1][STATS_BUCKETS];
+
+    //heap use, only counted by the tracking allocator of heap.h. the extra slot is for
+    //allocations made outside every phase
+    uint64_t allocations[PHASE_COUNT + 1];
+    uint64_t allocatedBytes[PHASE_COUNT + 1];
+    uint64_t frameAllocations, frameAllocationsMax, allocatingFrames;
+    //bytes this thread allocated minus bytes it freed, and the most that grew within a frame
+    int64_t heapNet, heapFrameBase, heapFramePeak, heapFramePeakMax;
+};
+
+uint64_t statsNow();
+PhaseStats& phaseStats();
+void statsReset();
+void statsAdd(Phase phase, uint64_t ns);
+void statsAllocation(size_t bytes);
+void statsFree(size_t bytes);
+
+//marks phase as running on this thread and returns the one it interrupted, PHASE_COUNT for none
+Phase statsEnter(Phase phase);
+void statsLeave(Phase outer);
+//closes the frame, adding its phases to the totals, the histograms and the trace
+void statsEndFrame();
+void statsPrint(FILE* file);
+
+struct PhaseScope{
+    Phase phase;
+    Phase outer;
+    uint64_t start;
+
+    PhaseScope(Phase phase) : phase(phase), outer(statsEnter(phase)), start(statsNow()){}
+    ~PhaseScope(){
+        uint64_t end = statsNow();
+        statsAdd(phase, end - start);
+        traceRecord(phase, start, end);
+        statsLeave(outer);
+    }
+};
+
+#define PHASE_CONCAT2(a, b) a##b
+#define PHASE_CONCAT(a, b) PHASE_CONCAT2(a, b)
+#if PHASE_TIMING
+#define PHASE_SCOPE(phase) PhaseScope PHASE_CONCAT(phaseScope, __LINE__)(phase)
+#else
+#define PHASE_SCOPE(phase) ((void)0)
+#endif
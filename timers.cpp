@@ -0,0 +1,161 @@
+#include "timers.h"
+
+#include <cstring>
+
+#define TIMER_FREE 0xFFFF
+
+static void timerLink(TimerWheel* wheel, uint32_t node, uint16_t bucket){
+    uint32_t head = wheel->heads[bucket];
+    wheel->bucket[node] = bucket;
+    wheel->prev[node] = TIMER_NONE;
+    wheel->next[node] = head;
+    if (head != TIMER_NONE) wheel->prev[head] = node;
+    wheel->heads[bucket] = node;
+}
+
+static void timerUnlink(TimerWheel* wheel, uint32_t node){
+    uint32_t prev = wheel->prev[node];
+    uint32_t next = wheel->next[node];
+    if (prev != TIMER_NONE) wheel->next[prev] = next;
+    else wheel->heads[wheel->bucket[node]] = next;
+    if (next != TIMER_NONE) wheel->prev[next] = prev;
+}
+
+static void timerRelease(TimerWheel* wheel, uint32_t node){
+    wheel->bucket[node] = TIMER_FREE;
+    wheel->generation[node]++;
+    wheel->next[node] = wheel->freeHead;
+    wheel->freeHead = node;
+    wheel->activeNum--;
+}
+
+//files a timer under the coarsest level whose window still separates it from now
+static void timerPlace(TimerWheel* wheel, uint32_t node){
+    uint64_t expiry = wheel->expiry[node];
+    uint64_t delta = expiry - wheel->now;
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++){
+        uint32_t shift = level * TIMER_WHEEL_BITS;
+        if (delta < ((uint64_t)TIMER_WHEEL_SLOTS << shift)){
+            uint32_t slot = (uint32_t)(expiry >> shift) & (TIMER_WHEEL_SLOTS - 1);
+            timerLink(wheel, node, (uint16_t)(level * TIMER_WHEEL_SLOTS + slot));
+            return;
+        }
+    }
+
+    //beyond the top level, park in the slot just behind now and re-place on cascade
+    uint32_t shift = (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_BITS;
+    uint32_t slot = (uint32_t)((wheel->now >> shift) - 1) & (TIMER_WHEEL_SLOTS - 1);
+    timerLink(wheel, node, (uint16_t)((TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_SLOTS + slot));
+}
+
+void timerWheelInit(TimerWheel* wheel, Arena* arena, size_t capacity){
+    memset(wheel, 0, sizeof(TimerWheel));
+    wheel->capacity = capacity ? capacity : 1;
+    wheel->expiry = arenaAlloc<uint64_t>(arena, wheel->capacity);
+    wheel->kind = arenaAlloc<uint16_t>(arena, wheel->capacity);
+    wheel->payload = arenaAlloc<uint32_t>(arena, wheel->capacity);
+    wheel->next = arenaAlloc<uint32_t>(arena, wheel->capacity);
+    wheel->prev = arenaAlloc<uint32_t>(arena, wheel->capacity);
+    wheel->generation = arenaAlloc<uint32_t>(arena, wheel->capacity);
+    wheel->bucket = arenaAlloc<uint16_t>(arena, wheel->capacity);
+    if (arenaMeasuring(*arena)) return;
+
+    for (size_t i = 0; i < TIMER_BUCKETS; i++){
+        wheel->heads[i] = TIMER_NONE;
+    }
+
+    //nodes go on the free list in index order
+    wheel->freeHead = TIMER_NONE;
+    for (size_t i = wheel->capacity; i-- > 0;){
+        wheel->generation[i] = 0;
+        wheel->bucket[i] = TIMER_FREE;
+        wheel->next[i] = wheel->freeHead;
+        wheel->freeHead = (uint32_t)i;
+    }
+}
+
+void timerWheelClear(TimerWheel* wheel){
+    for (size_t i = 0; i < TIMER_BUCKETS; i++){
+        while (wheel->heads[i] != TIMER_NONE){
+            uint32_t node = wheel->heads[i];
+            timerUnlink(wheel, node);
+            timerRelease(wheel, node);
+        }
+    }
+    wheel->now = 0;
+}
+
+TimerHandle timerStart(TimerWheel* wheel, uint64_t delay, uint16_t kind, uint32_t payload){
+    if (wheel->freeHead == TIMER_NONE){
+        TimerHandle none = {TIMER_NONE, 0};
+        return none;
+    }
+
+    uint32_t node = wheel->freeHead;
+    wheel->freeHead = wheel->next[node];
+    wheel->activeNum++;
+
+    wheel->expiry[node] = wheel->now + (delay ? delay : 1);
+    wheel->kind[node] = kind;
+    wheel->payload[node] = payload;
+    timerPlace(wheel, node);
+
+    TimerHandle handle;
+    handle.index = node;
+    handle.generation = wheel->generation[node];
+    return handle;
+}
+
+bool timerCancel(TimerWheel* wheel, TimerHandle handle){
+    if (handle.index >= wheel->capacity) return false;
+    if (wheel->generation[handle.index] != handle.generation || wheel->bucket[handle.index] == TIMER_FREE) return false;
+
+    timerUnlink(wheel, handle.index);
+    timerRelease(wheel, handle.index);
+    return true;
+}
+
+static void timerCascade(TimerWheel* wheel, uint32_t level){
+    uint32_t shift = level * TIMER_WHEEL_BITS;
+    uint32_t slot = (uint32_t)(wheel->now >> shift) & (TIMER_WHEEL_SLOTS - 1);
+    uint16_t bucket = (uint16_t)(level * TIMER_WHEEL_SLOTS + slot);
+
+    uint32_t node = wheel->heads[bucket];
+    wheel->heads[bucket] = TIMER_NONE;
+    while (node != TIMER_NONE){
+        uint32_t next = wheel->next[node];
+        timerPlace(wheel, node);
+        node = next;
+    }
+}
+
+void timerWheelAdvance(TimerWheel* wheel){
+    wheel->now++;
+
+    //when a lower level wraps, the next slot of the level above is due to be redistributed
+    for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++){
+        if (wheel->now & (((uint64_t)1 << (level * TIMER_WHEEL_BITS)) - 1)) break;
+        timerCascade(wheel, level);
+    }
+
+    uint16_t bucket = (uint16_t)(wheel->now & (TIMER_WHEEL_SLOTS - 1));
+    uint32_t node = wheel->heads[bucket];
+    wheel->heads[bucket] = TIMER_NONE;
+    while (node != TIMER_NONE){
+        uint32_t next = wheel->next[node];
+        timerLink(wheel, node, TIMER_EXPIRED);
+        node = next;
+    }
+}
+
+bool timerPop(TimerWheel* wheel, TimerEvent* event){
+    uint32_t node = wheel->heads[TIMER_EXPIRED];
+    if (node == TIMER_NONE) return false;
+
+    event->kind = wheel->kind[node];
+    event->payload = wheel->payload[node];
+    timerUnlink(wheel, node);
+    timerRelease(wheel, node);
+    return true;
+}
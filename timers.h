@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "arena.h"
+
+#define TIMER_WHEEL_LEVELS 3
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_BUCKETS (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1)
+#define TIMER_EXPIRED (TIMER_BUCKETS - 1)
+#define TIMER_NONE 0xFFFFFFFFu
+
+enum TimerKind : uint16_t{
+    TIMER_ALIEN_DEATH = 0,
+    TIMER_ALIEN_FIRE = 1,
+    TIMER_PLAYER_RESPAWN = 2
+};
+
+struct TimerEvent{
+    uint16_t kind;
+    uint32_t payload;
+};
+
+struct TimerHandle{
+    uint32_t index;
+    uint32_t generation;
+};
+
+//hierarchical timer wheel, level n slots are 64^n ticks wide. timers are pooled
+//nodes in intrusive lists, so starting and cancelling are O(1) and advancing a
+//tick only touches the timers that expire or cascade down a level.
+//the node pool lives in the owner's arena, so the capacity is fixed.
+struct TimerWheel{
+    uint64_t now;
+    size_t capacity;
+    size_t activeNum;
+    uint32_t freeHead;
+    RelPtr<uint64_t> expiry;
+    RelPtr<uint16_t> kind;
+    RelPtr<uint32_t> payload;
+    RelPtr<uint32_t> next;
+    RelPtr<uint32_t> prev;
+    RelPtr<uint32_t> generation;
+    RelPtr<uint16_t> bucket;
+    uint32_t heads[TIMER_BUCKETS];
+};
+
+void timerWheelInit(TimerWheel* wheel, Arena* arena, size_t capacity);
+void timerWheelClear(TimerWheel* wheel);
+
+//fires after delay calls to timerWheelAdvance, a delay of 0 counts as 1.
+//returns a handle with index TIMER_NONE if every node is in use
+TimerHandle timerStart(TimerWheel* wheel, uint64_t delay, uint16_t kind, uint32_t payload);
+bool timerCancel(TimerWheel* wheel, TimerHandle handle);
+
+//moves the wheel forward one tick, expired timers are then drained with timerPop
+void timerWheelAdvance(TimerWheel* wheel);
+bool timerPop(TimerWheel* wheel, TimerEvent* event);
@@ -0,0 +1,101 @@
+#include "trace.h"
+#include "stats.h"
+
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+thread_local TraceRing* traceRing = nullptr;
+
+static mutex traceLock;
+static TraceRing* rings[TRACE_THREAD_CAPACITY];
+static uint32_t threadNum = 0;
+
+bool traceAttach(size_t capacity, const char* name){
+    if (traceRing) return true;
+
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+
+    lock_guard<mutex> guard(traceLock);
+    size_t slot = 0;
+    while (slot < TRACE_THREAD_CAPACITY && rings[slot]) slot++;
+    if (slot == TRACE_THREAD_CAPACITY){
+        cout << "Too many traced threads, " << name << " is not traced" << endl;
+        return false;
+    }
+
+    TraceRing* ring = new TraceRing;
+    ring->events = new TraceEvent[size];
+    ring->mask = size - 1;
+    ring->count = 0;
+    ring->thread = ++threadNum;
+    ring->name = name;
+    rings[slot] = ring;
+    traceRing = ring;
+    return true;
+}
+
+void traceDetach(){
+    TraceRing* ring = traceRing;
+    if (!ring) return;
+    traceRing = nullptr;
+
+    lock_guard<mutex> guard(traceLock);
+    for (size_t i = 0; i < TRACE_THREAD_CAPACITY; i++){
+        if (rings[i] == ring) rings[i] = nullptr;
+    }
+    delete[] ring->events;
+    delete ring;
+}
+
+//the oldest event a ring still holds
+static uint64_t traceFirst(const TraceRing& ring){
+    return ring.count > ring.mask + 1 ? ring.count - (ring.mask + 1) : 0;
+}
+
+bool traceWrite(const char* path){
+    FILE* file = fopen(path, "w");
+    if (!file){
+        cout << "Failed to create trace " << path << endl;
+        return false;
+    }
+
+    lock_guard<mutex> guard(traceLock);
+
+    //timestamps are microseconds from the oldest recorded event
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < TRACE_THREAD_CAPACITY; i++){
+        if (!rings[i]) continue;
+        for (uint64_t n = traceFirst(*rings[i]); n < rings[i]->count; n++){
+            uint64_t start = rings[i]->events[n & rings[i]->mask].start;
+            if (start < origin) origin = start;
+        }
+    }
+
+    uint64_t eventNum = 0;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < TRACE_THREAD_CAPACITY; i++){
+        const TraceRing* ring = rings[i];
+        if (!ring) continue;
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", ring->thread, ring->name);
+        first = false;
+        for (uint64_t n = traceFirst(*ring); n < ring->count; n++){
+            const TraceEvent& event = ring->events[n & ring->mask];
+            const char* name = event.phase < PHASE_COUNT ? phaseNames[event.phase] : "frame";
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", name, ring->thread,
+                (event.start - origin) / 1000.0, event.duration / 1000.0);
+            eventNum++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = fclose(file) == 0;
+    if (ok) cout << "wrote " << eventNum << " trace events to " << path << endl;
+    else cout << "Failed to write trace " << path << endl;
+    return ok;
+}
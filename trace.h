@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//the phases and frames of a thread that has called traceAttach land in its ring, which
+//keeps the newest capacity of them. traceWrite exports every ring as a Chrome trace, load
+//it in chrome://tracing or ui.perfetto.dev
+#define TRACE_THREAD_CAPACITY 16
+//about 15 events a frame, so minutes of a 60 Hz game in 4 MB
+#define TRACE_EVENT_CAPACITY (1 << 18)
+
+//phase is a Phase, or PHASE_COUNT for a whole frame
+struct TraceEvent{
+    uint64_t start;
+    uint32_t duration;
+    uint32_t phase;
+};
+
+struct TraceRing{
+    TraceEvent* events;
+    size_t mask;
+    uint64_t count;
+    uint32_t thread;
+    const char* name;
+};
+
+extern thread_local TraceRing* traceRing;
+
+//gives the calling thread a ring of capacity events, rounded up to a power of two. call
+//it before any heap guard, the ring is the only allocation
+bool traceAttach(size_t capacity, const char* name);
+
+inline void traceRecord(uint32_t phase, uint64_t start, uint64_t end){
+    TraceRing* ring = traceRing;
+    if (!ring) return;
+    TraceEvent& event = ring->events[ring->count++ & ring->mask];
+    event.start = start;
+    //clamped at about 4 s, long enough for any phase
+    event.duration = end - start > UINT32_MAX ? UINT32_MAX : (uint32_t)(end - start);
+    event.phase = phase;
+}
+
+//writes the rings of all threads as Chrome trace event JSON. the threads must be done
+//recording, rings are read without locks
+bool traceWrite(const char* path);
+
+//stops recording on the calling thread and frees its ring
+void traceDetach();
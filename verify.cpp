@@ -0,0 +1,248 @@
+#include "verify.h"
+#include "replay.h"
+#include "checksum.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+using namespace std;
+
+//a worker's share of the job indices. the owner takes from the front and thieves
+//split off the back half, so stolen work stays contiguous
+struct VerifyQueue{
+    mutex lock;
+    size_t begin, end;
+};
+
+struct VerifyResult{
+    const char* failure;
+    uint64_t tickNum;
+    uint64_t divergedTick;
+};
+
+//one reusable game per thread
+struct VerifyWorker{
+    Game* game;
+    GameConfig shape;
+};
+
+struct VerifyPool{
+    const vector<string>* paths;
+    const Assets* assets;
+    VerifyQueue* queues;
+    size_t queueNum;
+    VerifyResult* results;
+};
+
+static bool listReplays(const char* dir, vector<string>* paths){
+    string root = dir;
+    if (!root.empty() && root.back() != '/' && root.back() != '\\') root += '/';
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((root + "*.rep").c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE){
+        if (GetLastError() == ERROR_FILE_NOT_FOUND) return true;
+        cout << "Failed to list " << dir << endl;
+        return false;
+    }
+    do {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) paths->push_back(root + entry.cFileName);
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* listing = opendir(dir);
+    if (!listing){
+        cout << "Failed to list " << dir << endl;
+        return false;
+    }
+    while (dirent* entry = readdir(listing)){
+        size_t length = strlen(entry->d_name);
+        if (length > 4 && !strcmp(entry->d_name + length - 4, ".rep")) paths->push_back(root + entry->d_name);
+    }
+    closedir(listing);
+#endif
+
+    //listing order is filesystem dependent, sorting keeps reports comparable between runs
+    sort(paths->begin(), paths->end());
+    return true;
+}
+
+static bool fileExists(const string& path){
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fclose(file);
+    return true;
+}
+
+static bool verifyTake(VerifyPool* pool, size_t self, size_t* job){
+    VerifyQueue& own = pool->queues[self];
+    {
+        lock_guard<mutex> guard(own.lock);
+        if (own.begin < own.end){
+            *job = own.begin++;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < pool->queueNum; i++){
+        VerifyQueue& victim = pool->queues[(self + i) % pool->queueNum];
+        size_t begin, end;
+        {
+            lock_guard<mutex> guard(victim.lock);
+            size_t left = victim.end - victim.begin;
+            if (!left) continue;
+            begin = victim.end - (left + 1) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        lock_guard<mutex> guard(own.lock);
+        *job = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+//resets the worker's game for config, reallocating only when the shape changes. the fire
+//interval and bullet capacity size the bullet pool, so they are part of the shape
+static void verifyPrepare(VerifyWorker* worker, const GameConfig& config, const Assets& assets){
+    const GameConfig& shape = worker->shape;
+    bool same = worker->game && shape.width == config.width && shape.height == config.height &&
+                shape.rows == config.rows && shape.cols == config.cols && shape.botNum == config.botNum &&
+                shape.fireInterval == config.fireInterval && shape.bulletCapacity == config.bulletCapacity;
+
+    if (same){
+        gameReset(worker->game, assets, config.seed);
+        return;
+    }
+
+    gameDestroy(worker->game);
+    worker->game = gameCreate(config, assets);
+    worker->shape = config;
+}
+
+static void verifyOne(VerifyWorker* worker, const Assets& assets, const string& path, VerifyResult* result){
+    ReplayReader reader;
+    if (!replayOpen(&reader, path.c_str())){
+        result->failure = "unreadable";
+        return;
+    }
+
+    GameConfig config;
+    configDefaults(&config);
+    replayConfig(reader, &config);
+    if (!configValidate(&config)){
+        result->failure = "invalid config";
+        replayClose(&reader);
+        return;
+    }
+    verifyPrepare(worker, config, assets);
+    Game& game = *worker->game;
+
+    ChecksumReader sums;
+    string sumPath = path + ".sum";
+    bool checkTicks = fileExists(sumPath) && checksumOpen(&sums, sumPath.c_str());
+
+    GameInput input;
+    ChecksumRecord record;
+    while (replayNext(&reader, &input)){
+        gameStep(&game, assets, input);
+
+        uint64_t tick = game.tick - 1;
+        if (checkTicks && tick < sums.header->tickNum){
+            checksumGame(game, nullptr, &record);
+            if (record.state != sums.records[tick].state){
+                result->failure = "checksum stream diverged";
+                result->divergedTick = tick;
+                break;
+            }
+        }
+    }
+    result->tickNum = game.tick;
+
+    if (!result->failure){
+        checksumGame(game, nullptr, &record);
+        if (reader.tick != reader.header->tickNum) result->failure = "truncated";
+        else if (game.score != reader.header->score) result->failure = "score mismatch";
+        else if (record.state != reader.header->checksum) result->failure = "final checksum mismatch";
+    }
+
+    if (checkTicks) checksumClose(&sums);
+    replayClose(&reader);
+}
+
+static void verifyWorker(VerifyPool* pool, size_t self){
+    VerifyWorker worker = {};
+
+    size_t job;
+    while (verifyTake(pool, self, &job)){
+        verifyOne(&worker, *pool->assets, (*pool->paths)[job], &pool->results[job]);
+    }
+
+    gameDestroy(worker.game);
+}
+
+bool verifyReplays(const char* dir, size_t threads, const Assets& assets, VerifySummary* summary){
+    memset(summary, 0, sizeof(VerifySummary));
+
+    vector<string> paths;
+    if (!listReplays(dir, &paths)) return false;
+    size_t jobNum = paths.size();
+    if (!threads) threads = 1;
+    if (threads > jobNum) threads = jobNum ? jobNum : 1;
+
+    vector<VerifyResult> results(jobNum);
+    memset(results.data(), 0, jobNum * sizeof(VerifyResult));
+    vector<VerifyQueue> queues(threads);
+    for (size_t t = 0; t < threads; t++){
+        queues[t].begin = jobNum * t / threads;
+        queues[t].end = jobNum * (t + 1) / threads;
+    }
+
+    VerifyPool pool;
+    pool.paths = &paths;
+    pool.assets = &assets;
+    pool.queues = queues.data();
+    pool.queueNum = threads;
+    pool.results = results.data();
+
+    uint64_t start = statsNow();
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; t++){
+        workers.push_back(thread(verifyWorker, &pool, t));
+    }
+    for (thread& t : workers){
+        t.join();
+    }
+    summary->seconds = (statsNow() - start) * 1e-9;
+
+    summary->replayNum = jobNum;
+    for (size_t i = 0; i < jobNum; i++){
+        const VerifyResult& result = results[i];
+        summary->tickNum += result.tickNum;
+        if (!result.failure){
+            summary->passNum++;
+            continue;
+        }
+        cout << paths[i] << ": " << result.failure;
+        if (!strcmp(result.failure, "checksum stream diverged")) cout << " at tick " << result.divergedTick;
+        cout << endl;
+    }
+    return true;
+}
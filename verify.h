@@ -0,0 +1,17 @@
+#pragma once
+
+#include "assets.h"
+
+struct VerifySummary{
+    size_t replayNum;
+    size_t passNum;
+    uint64_t tickNum;
+    double seconds;
+};
+
+//re-simulates every .rep file in dir headlessly on a work-stealing pool of threads.
+//each replay must reach its recorded final score and state checksum, and match
+//its FILE.sum stream tick by tick when one exists. failures are printed.
+//workers keep one Game each and only reallocate it when a replay needs a
+//different shape, so memory stays bounded by the largest replay.
+bool verifyReplays(const char* dir, size_t threads, const Assets& assets, VerifySummary* summary);